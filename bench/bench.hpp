@@ -0,0 +1,77 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "lak/stdint.hpp"
+#include "lak/string_view.hpp"
+
+#include <chrono>
+#include <ostream>
+
+// number of calls to operator new since the program started.
+size_t allocation_count();
+
+// peak resident set size of the process in bytes, 0 where unsupported.
+size_t peak_rss();
+
+// restart peak_rss() from the current resident set size where the platform
+// supports it (linux), otherwise peak_rss() is the peak of the whole run.
+void reset_peak_rss();
+
+struct bench_stats
+{
+	size_t allocations = 0U;
+	double seconds     = 0.0;
+	size_t peak_rss    = 0U;
+};
+
+// runs func once and records how long it took, how much it allocated and
+// the peak memory use while it ran.
+template<typename FUNC>
+bench_stats measure(FUNC &&func)
+{
+	reset_peak_rss();
+	const size_t allocations = allocation_count();
+	const auto start         = std::chrono::steady_clock::now();
+	func();
+	const auto end = std::chrono::steady_clock::now();
+	return {
+	  .allocations = allocation_count() - allocations,
+	  .seconds     = std::chrono::duration<double>(end - start).count(),
+	  .peak_rss    = peak_rss(),
+	};
+}
+
+std::ostream &operator<<(std::ostream &strm, const bench_stats &stats);
+
+// prints throughput (MB/s, lines/s) and stats for one parser run.
+void report_parse(lak::astring_view name,
+                  size_t bytes,
+                  size_t lines,
+                  const bench_stats &stats,
+                  bool failed);
+
+struct fasm_bench_options
+{
+	size_t line_count         = 100000U;
+	// fraction of lines with a { key = "value" } annotation.
+	double annotation_density = 0.1;
+	// widest verilog value generated, in bits.
+	size_t max_value_width    = 256U;
+};
+
+void bigint_bench();
+
+// parses fasm, or a file generated from options if fasm is empty.
+void fasm_bench(lak::astring_view fasm, const fasm_bench_options &options);
+
+// package_pins.csv shaped file with row_count rows.
+void csv_bench(size_t row_count);
+
+// tilegrid.json shaped file with tile_count tiles.
+void json_bench(size_t tile_count);
+
+void segbits_bench();
+
+void scan_bench();
+
+#endif
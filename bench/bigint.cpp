@@ -0,0 +1,42 @@
+#include "bench.hpp"
+
+#include "bigint.hpp"
+
+#include <iostream>
+
+void bigint_bench()
+{
+	constexpr size_t iterations = 100000U;
+
+	lak::bigint acc;
+	const bench_stats stats = measure(
+	  [&]
+	  {
+		  for (size_t i = 0U; i < iterations; ++i)
+		  {
+			  // typical 2 limb value, built and combined the way the parser does.
+			  lak::bigint value = uintmax_t(i);
+			  value *= UINTMAX_MAX;
+			  value += uintmax_t(i);
+			  acc = value * value;
+		  }
+	  });
+
+	std::cout << "bigint small arithmetic: " << iterations << " iterations, "
+	          << stats << "\n";
+
+	// a 4096 bit value, the size of a BRAM INIT block.
+	lak::bigint wide = uintmax_t(1U);
+	for (size_t i = 0U; i < 64U; ++i) wide = wide * UINTMAX_MAX + uintmax_t(i);
+
+	size_t digit_count = 0U;
+	const bench_stats dec_stats =
+	  measure([&] { digit_count = wide.to_string().size(); });
+	std::cout << "bigint to decimal: " << digit_count << " digits, " << dec_stats
+	          << "\n";
+
+	const bench_stats hex_stats = measure(
+	  [&] { digit_count = wide.to_string(lak::numeric_base::hex).size(); });
+	std::cout << "bigint to hex: " << digit_count << " digits, " << hex_stats
+	          << "\n";
+}
@@ -0,0 +1,43 @@
+#include "bench.hpp"
+
+#include "csv.hpp"
+
+#include <iostream>
+#include <sstream>
+
+// rows look like prjxray's package_pins.csv.
+static std::string generate_csv(size_t row_count)
+{
+	std::stringstream strm;
+	strm << "pin,bank,site,tile,pin_function\n";
+
+	for (size_t i = 0U; i < row_count; ++i)
+	{
+		const size_t bank = 14U + (i % 22U);
+		const size_t y    = i % 200U;
+		strm << char('A' + (i % 22U)) << (1U + (i / 22U)) << "," << bank
+		     << ",IOB_X" << (i % 2U) << "Y" << y << ",LIOB33_X" << (i % 2U) << "Y"
+		     << y << ",IO_L" << (1U + (y % 24U)) << ((i & 1U) ? "N" : "P")
+		     << "_T" << (y % 4U) << "_" << bank << "\n";
+	}
+
+	return strm.str();
+}
+
+void csv_bench(size_t row_count)
+{
+	const std::string csv = generate_csv(row_count);
+	const lak::astring_view view(csv.data(), csv.data() + csv.size());
+
+	size_t line_count = 0U;
+	bool failed       = false;
+	const bench_stats stats = measure(
+	  [&]
+	  {
+		  auto result = csv_parser{view}.parse();
+		  failed      = result.is_err();
+		  if (!failed) line_count = result.unwrap().size();
+	  });
+
+	report_parse("csv parse"_view, view.size(), line_count, stats, failed);
+}
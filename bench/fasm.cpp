@@ -0,0 +1,75 @@
+#include "bench.hpp"
+
+#include "fasm.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+static void generate_value(std::stringstream &strm,
+                           std::mt19937_64 &rng,
+                           size_t width)
+{
+	strm << width << "'h";
+	// top digit only holds the bits left over from the full nibbles.
+	const size_t digits = (width + 3U) / 4U;
+	const size_t top    = width % 4U;
+	for (size_t i = 0U; i < digits; ++i)
+	{
+		const uint64_t digit = rng() & ((i == 0U && top != 0U) ? ((1U << top) - 1U)
+		                                                       : 0xFU);
+		strm << "0123456789ABCDEF"[digit];
+	}
+}
+
+static std::string generate_fasm(const fasm_bench_options &options)
+{
+	std::mt19937_64 rng(0x5EED);
+	std::uniform_real_distribution<double> annotation_dist(0.0, 1.0);
+	std::uniform_int_distribution<size_t> width_dist(
+	  1U, std::max<size_t>(options.max_value_width, 1U));
+	std::stringstream strm;
+
+	for (size_t i = 0U; i < options.line_count; ++i)
+	{
+		strm << "CLBLL_L_X" << (i % 100U) << "Y" << (i % 150U) << ".SLICEL_X0.";
+		switch (i % 4U)
+		{
+			case 0: strm << "AFF.ZINI"; break;
+			case 1: strm << "CEUSEDMUX = 1'b1"; break;
+			default:
+			{
+				const size_t width = width_dist(rng);
+				strm << "INIT_" << (i % 64U) << "[" << (width - 1U) << ":0] = ";
+				generate_value(strm, rng, width);
+			}
+			break;
+		}
+		if (annotation_dist(rng) < options.annotation_density)
+			strm << " { source = \"line" << i << "\", .attr = \"x\" }";
+		strm << "\n";
+	}
+
+	return strm.str();
+}
+
+void fasm_bench(lak::astring_view fasm, const fasm_bench_options &options)
+{
+	std::string generated;
+	if (fasm.empty())
+	{
+		generated = generate_fasm(options);
+		fasm      = lak::astring_view(generated.data(),
+                                 generated.data() + generated.size());
+	}
+
+	size_t line_count = 0U;
+	bool failed       = false;
+	const bench_stats stats =
+	  measure([&] { failed = fasm_parser{fasm}.parse([&](fasm_parser::line &&)
+	                                                { ++line_count; })
+	                           .is_err(); });
+
+	report_parse("fasm parse"_view, fasm.size(), line_count, stats, failed);
+}
@@ -0,0 +1,56 @@
+#include "bench.hpp"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+// pretty printed like prjxray's tilegrid.json.
+static std::string generate_json(size_t tile_count)
+{
+	std::stringstream strm;
+	strm << "{\n";
+
+	for (size_t i = 0U; i < tile_count; ++i)
+	{
+		const size_t x = i % 100U;
+		const size_t y = i / 100U;
+		strm << "    \"CLBLL_L_X" << x << "Y" << y << "\": {\n"
+		     << "        \"bits\": {\n"
+		     << "            \"CLB_IO_CLK\": {\n"
+		     << "                \"baseaddr\": \"0x00" << std::hex
+		     << (0x400000U + (x << 7U)) << std::dec << "\",\n"
+		     << "                \"frames\": 36,\n"
+		     << "                \"offset\": " << ((y % 50U) * 2U) << ",\n"
+		     << "                \"words\": 2\n"
+		     << "            }\n"
+		     << "        },\n"
+		     << "        \"grid_x\": " << x << ",\n"
+		     << "        \"grid_y\": " << y << ",\n"
+		     << "        \"sites\": {\n"
+		     << "            \"SLICE_X" << (x * 2U) << "Y" << y
+		     << "\": \"SLICEL\",\n"
+		     << "            \"SLICE_X" << (x * 2U + 1U) << "Y" << y
+		     << "\": \"SLICEL\"\n"
+		     << "        },\n"
+		     << "        \"type\": \"CLBLL_L\"\n"
+		     << "    }" << (i + 1U < tile_count ? ",\n" : "\n");
+	}
+
+	strm << "}\n";
+	return strm.str();
+}
+
+void json_bench(size_t tile_count)
+{
+	const std::string json = generate_json(tile_count);
+	const lak::astring_view view(json.data(), json.data() + json.size());
+	const size_t line_count = size_t(std::count(json.begin(), json.end(), '\n'));
+
+	bool failed             = false;
+	const bench_stats stats =
+	  measure([&] { failed = json_parser{view}.parse().is_err(); });
+
+	report_parse("json parse"_view, view.size(), line_count, stats, failed);
+}
@@ -0,0 +1,167 @@
+#include "bench.hpp"
+
+#include "fasm2bit.hpp"
+
+#include "lak/string_literals.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#	include <sys/resource.h>
+#endif
+
+static std::atomic<size_t> allocations = 0U;
+
+void *operator new(size_t size)
+{
+	allocations.fetch_add(1U, std::memory_order_relaxed);
+	if (void *result = std::malloc(size == 0U ? 1U : size); result)
+		return result;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+size_t allocation_count()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+size_t peak_rss()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0U;
+#	if defined(__APPLE__)
+	return size_t(usage.ru_maxrss);
+#	else
+	return size_t(usage.ru_maxrss) * 1024U;
+#	endif
+#else
+	return 0U;
+#endif
+}
+
+void reset_peak_rss()
+{
+#if defined(__linux__)
+	// "5" resets the peak RSS counter (linux 4.0+), silently ignored if the
+	// kernel doesn't support it.
+	std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+std::ostream &operator<<(std::ostream &strm, const bench_stats &stats)
+{
+	strm << std::fixed << std::setprecision(3) << stats.seconds * 1000.0
+	     << " ms, " << stats.allocations << " allocations";
+	if (stats.peak_rss > 0U)
+		strm << ", " << std::setprecision(1)
+		     << double(stats.peak_rss) / (1024.0 * 1024.0) << " MiB peak RSS";
+	return strm;
+}
+
+void report_parse(lak::astring_view name,
+                  size_t bytes,
+                  size_t lines,
+                  const bench_stats &stats,
+                  bool failed)
+{
+	std::cout << name << ": " << lines << " lines, " << std::fixed
+	          << std::setprecision(1)
+	          << double(bytes) / (1000.0 * 1000.0) / stats.seconds << " MB/s, "
+	          << double(lines) / stats.seconds << " lines/s, " << stats;
+	if (lines > 0U)
+		std::cout << " (" << std::setprecision(3)
+		          << double(stats.allocations) / double(lines) << " per line)";
+	if (failed) std::cout << " FAILED";
+	std::cout << "\n";
+}
+
+static const lak::astring_view usage =
+  "Usage: fasm2bit-bench "
+  "[--fasm <path to fasm>] "
+  "[--lines <generated fasm lines>] "
+  "[--annotation-density <0 to 1>] "
+  "[--value-width <max generated value bits>] "
+  "[--csv-rows <generated csv rows>] "
+  "[--json-tiles <generated json tiles>]"_view;
+
+template<typename T>
+static bool parse_arg(const char *arg, T &value)
+{
+	const lak::astring_view str = lak::astring_view::from_c_str(arg);
+	const auto [ptr, ec] = std::from_chars(str.begin(), str.end(), value);
+	return ec == std::errc{} && ptr == str.end();
+}
+
+int main(int argc, const char **argv)
+{
+	fs::path fasm_path;
+	fasm_bench_options fasm_options;
+	size_t csv_rows   = 200000U;
+	size_t json_tiles = 50000U;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto arg = lak::astring_view::from_c_str(argv[i]);
+		if (i + 1 >= argc) return user_error(usage);
+
+		bool ok = true;
+		if (arg == "--fasm"_view)
+			fasm_path = argv[++i];
+		else if (arg == "--lines"_view)
+			ok = parse_arg(argv[++i], fasm_options.line_count);
+		else if (arg == "--annotation-density"_view)
+			ok = parse_arg(argv[++i], fasm_options.annotation_density);
+		else if (arg == "--value-width"_view)
+			ok = parse_arg(argv[++i], fasm_options.max_value_width) &&
+			     fasm_options.max_value_width > 0U;
+		else if (arg == "--csv-rows"_view)
+			ok = parse_arg(argv[++i], csv_rows);
+		else if (arg == "--json-tiles"_view)
+			ok = parse_arg(argv[++i], json_tiles);
+		else
+			ok = false;
+
+		if (!ok) return user_error(usage);
+	}
+
+	bigint_bench();
+
+	segbits_bench();
+
+	scan_bench();
+
+	if (fasm_path.empty())
+	{
+		fasm_bench({}, fasm_options);
+	}
+	else
+	{
+		if_let_ok (const mapped_file file, map_file(fasm_path))
+			fasm_bench(file.view(), fasm_options);
+		else
+			return user_error("Failed to open fasm file ", fasm_path);
+	}
+
+	csv_bench(csv_rows);
+
+	json_bench(json_tiles);
+
+	return EXIT_SUCCESS;
+}
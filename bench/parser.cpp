@@ -0,0 +1,95 @@
+#include "bench.hpp"
+
+#include "parser.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+
+static void report(const char *name, size_t bytes, const bench_stats &stats)
+{
+	std::cout << "  " << name << ": " << stats << ", "
+	          << double(bytes) / (1024.0 * 1024.0) / stats.seconds << " MiB/s\n";
+}
+
+void scan_bench()
+{
+	constexpr size_t size = 32U * 1024U * 1024U;
+
+	// comment/string like text with a delimiter every ~100 bytes, and runs of
+	// indentation like a pretty printed JSON file.
+	std::mt19937_64 rng(0x5EED);
+	std::string text(size, 'x');
+	for (size_t i = 0U; i < size; i += 64U + (rng() % 72U)) text[i] = '\n';
+	std::string space(size, ' ');
+	for (size_t i = 0U; i < size; i += 16U + (rng() % 48U)) space[i] = 'x';
+
+	const auto view = [](const std::string &str)
+	{ return lak::astring_view(str.data(), str.data() + str.size()); };
+
+	std::cout << "parser scanning (" << size / (1024U * 1024U) << " MiB):\n";
+
+	size_t lines = 0U;
+	report("pop_not_char until newline",
+	       size,
+	       measure(
+	         [&]
+	         {
+		         basic_parser parser{view(text)};
+		         while (!parser.input.empty())
+		         {
+			         while (parser.pop_not_char<char_classes::newline>().is_ok())
+				         ;
+			         parser.pop().discard();
+			         ++lines;
+		         }
+	         }));
+
+	size_t simd_lines = 0U;
+	report("skip_until newline",
+	       size,
+	       measure(
+	         [&]
+	         {
+		         basic_parser parser{view(text)};
+		         while (!parser.input.empty())
+		         {
+			         parser.skip_until<char_classes::newline>();
+			         parser.pop().discard();
+			         ++simd_lines;
+		         }
+	         }));
+
+	size_t runs = 0U;
+	report("pop_char whitespace",
+	       size,
+	       measure(
+	         [&]
+	         {
+		         basic_parser parser{view(space)};
+		         while (!parser.input.empty())
+		         {
+			         while (parser.pop_char<char_classes::whitespace>().is_ok())
+				         ;
+			         parser.pop().discard();
+			         ++runs;
+		         }
+	         }));
+
+	size_t simd_runs = 0U;
+	report("skip_while whitespace",
+	       size,
+	       measure(
+	         [&]
+	         {
+		         basic_parser parser{view(space)};
+		         while (!parser.input.empty())
+		         {
+			         parser.skip_while<char_classes::whitespace>();
+			         parser.pop().discard();
+			         ++simd_runs;
+		         }
+	         }));
+
+	if (lines != simd_lines || runs != simd_runs) std::cout << "  MISMATCH\n";
+}
@@ -0,0 +1,125 @@
+#include "bench.hpp"
+
+#include "database.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+// feature names shaped like the CLB and interconnect segbits files.
+static std::vector<std::string> generate_features()
+{
+	std::vector<std::string> result;
+
+	for (const char *slice :
+	     {"SLICEL_X0", "SLICEL_X1", "SLICEM_X0", "SLICEM_X1"})
+	{
+		for (const char lut : {'A', 'B', 'C', 'D'})
+		{
+			for (size_t i = 0U; i < 64U; ++i)
+				result.push_back(std::string(slice) + "." + lut + "6LUT.INIT[" +
+				                 (i < 10U ? "0" : "") + std::to_string(i) + "]");
+			for (const char *suffix :
+			     {"FF.ZINI", "FF.ZRST", "5FF.ZINI", "OUTMUX.O6"})
+				result.push_back(std::string(slice) + "." + lut + suffix);
+		}
+		result.push_back(std::string(slice) + ".CEUSEDMUX");
+		result.push_back(std::string(slice) + ".SRUSEDMUX");
+	}
+
+	for (size_t dst = 0U; dst < 48U; ++dst)
+		for (size_t src = 0U; src < 24U; ++src)
+			result.push_back("INT_L.IMUX_L" + std::to_string(dst) +
+			                 ".LOGIC_OUTS_L" + std::to_string(src));
+
+	return result;
+}
+
+void segbits_bench()
+{
+	constexpr size_t lookup_count = 1000000U;
+
+	const std::vector<std::string> features = generate_features();
+
+	std::mt19937_64 rng(0x5EED);
+	std::unordered_map<std::string, std::vector<segbit>> string_map;
+	tile_segbits flat;
+	std::vector<symbol_id> ids;
+	std::vector<lak::astring_view> names;
+	for (const auto &feature : features)
+	{
+		std::vector<segbit> bits(1U + (rng() % 4U));
+		for (auto &bit : bits)
+			bit = segbit::make(
+			  uint32_t(rng() % 36U), uint32_t(rng() % 64U), (rng() % 8U) != 0U);
+		const lak::astring_view name(feature.data(),
+		                             feature.data() + feature.size());
+		names.push_back(name);
+		ids.push_back(symbol_table::global().intern(name));
+		flat.insert(ids.back(), lak::span(bits));
+		string_map.emplace(feature, lak::move(bits));
+	}
+
+	// designs hit a few features (LUT inits, common muxes) far more often than
+	// the rest.
+	std::vector<size_t> lookups(lookup_count);
+	for (auto &index : lookups)
+		index = (rng() % 2U) ? rng() % (features.size() / 20U)
+		                     : rng() % features.size();
+
+	size_t string_bits = 0U;
+	const bench_stats string_stats = measure(
+	  [&]
+	  {
+		  for (const size_t index : lookups)
+			  string_bits += string_map.find(features[index])->second.size();
+	  });
+
+	size_t flat_bits = 0U;
+	const bench_stats flat_stats = measure(
+	  [&]
+	  {
+		  for (const size_t index : lookups)
+			  if_let_ok (const lak::span<const segbit> bits, flat.find(ids[index]))
+				  flat_bits += bits.size();
+	  });
+
+	// the ids aren't free, the parser interns each feature name it reads.
+	size_t interned_bits = 0U;
+	const bench_stats interned_stats = measure(
+	  [&]
+	  {
+		  symbol_table &symbols = symbol_table::global();
+		  for (const size_t index : lookups)
+			  if_let_ok (const lak::span<const segbit> bits,
+			             flat.find(symbols.intern(names[index])))
+				  interned_bits += bits.size();
+	  });
+
+	// what the parser does, one cache per parsing thread.
+	size_t cached_bits = 0U;
+	const bench_stats cached_stats = measure(
+	  [&]
+	  {
+		  symbol_cache symbols(symbol_table::global());
+		  for (const size_t index : lookups)
+			  if_let_ok (const lak::span<const segbit> bits,
+			             flat.find(symbols.intern(names[index])))
+				  cached_bits += bits.size();
+	  });
+
+	std::cout << "segbits lookup (" << features.size() << " features, "
+	          << lookup_count << " lookups):\n"
+	          << "  string keyed map: " << string_stats << ", "
+	          << double(lookup_count) / string_stats.seconds << " lookups/s\n"
+	          << "  flat symbol map: " << flat_stats << ", "
+	          << double(lookup_count) / flat_stats.seconds << " lookups/s\n"
+	          << "  intern + flat symbol map: " << interned_stats << ", "
+	          << double(lookup_count) / interned_stats.seconds << " lookups/s\n"
+	          << "  cached intern + flat symbol map: " << cached_stats << ", "
+	          << double(lookup_count) / cached_stats.seconds << " lookups/s\n";
+	if (string_bits != flat_bits || string_bits != interned_bits ||
+	    string_bits != cached_bits)
+		std::cout << "  MISMATCH\n";
+}
@@ -0,0 +1,82 @@
+#ifndef LAK_ARENA_HPP
+#define LAK_ARENA_HPP
+
+#include "lak/span.hpp"
+#include "lak/stdint.hpp"
+#include "lak/utility.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace lak
+{
+	// bump allocator. everything allocated from it is released in one go when
+	// the arena is destroyed, destructors are never run so it must only hold
+	// objects that don't own anything outside of the arena.
+	struct arena
+	{
+		static constexpr size_t block_size = 0x10000U;
+
+	private:
+		std::vector<std::unique_ptr<std::byte[]>> _blocks;
+		std::byte *_block = nullptr;
+		size_t _used      = 0U;
+
+	public:
+		arena() = default;
+		arena(const arena &) = delete;
+		arena &operator=(const arena &) = delete;
+
+		arena(arena &&other) { *this = lak::move(other); }
+
+		arena &operator=(arena &&other)
+		{
+			if (this == &other) return *this;
+			_blocks      = lak::move(other._blocks);
+			_block       = other._block;
+			_used        = other._used;
+			other._block = nullptr;
+			other._used  = 0U;
+			return *this;
+		}
+
+		// uninitialised, align must not exceed alignof(std::max_align_t).
+		void *allocate(size_t size, size_t align)
+		{
+			if (size > block_size / 4U)
+			{
+				// big allocations get their own block so they don't waste the
+				// current one.
+				_blocks.push_back(std::make_unique<std::byte[]>(size));
+				return _blocks.back().get();
+			}
+
+			size_t offset = (_used + align - 1U) & ~(align - 1U);
+			if (!_block || offset + size > block_size)
+			{
+				_blocks.push_back(std::make_unique<std::byte[]>(block_size));
+				_block = _blocks.back().get();
+				offset = 0U;
+			}
+			_used = offset + size;
+			return _block + offset;
+		}
+
+		// move [begin, end) into one contiguous run of the arena.
+		template<typename T>
+		lak::span<T> move_range(T *begin, T *end)
+		{
+			static_assert(alignof(T) <= alignof(std::max_align_t));
+			const size_t count = size_t(end - begin);
+			if (count == 0U) return {};
+			T *data = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+			std::uninitialized_move(begin, end, data);
+			return lak::span<T>(data, count);
+		}
+
+		size_t block_count() const { return _blocks.size(); }
+	};
+}
+
+#endif
@@ -1,12 +1,17 @@
 #ifndef LAK_BIGINT_HPP
 #define LAK_BIGINT_HPP
 
+#include "numeric.hpp"
+#include "small_vector.hpp"
+
 #include "lak/compare.hpp"
 #include "lak/defer.hpp"
 #include "lak/result.hpp"
 #include "lak/span.hpp"
 #include "lak/stdint.hpp"
 
+#include <string>
+
 namespace lak
 {
 	struct bigint
@@ -15,7 +20,8 @@ namespace lak
 
 	private:
 		bool _negative = false;
-		std::vector<uintmax_t> _data;
+		// most values fit in a few limbs, only spill to the heap beyond that.
+		lak::small_vector<uintmax_t, 4U> _data;
 
 		bigint &negate();
 		void reserve(size_t count);
@@ -34,6 +40,13 @@ namespace lak
 		[[nodicard]] div_rem_result div_rem_impl(const bigint &value,
 		                                         bool negate_result) const;
 
+		// ignores _negative
+		void append_pow2_digits(std::string &str, unsigned bits_per_digit) const;
+		// powers[i] = 10^(19 * 2^i), this must be less than powers.back()^2.
+		void append_dec_digits(std::string &str,
+		                       size_t min_digits,
+		                       lak::span<const bigint> powers) const;
+
 	public:
 		bigint()               = default;
 		bigint(const bigint &) = default;
@@ -51,6 +64,9 @@ namespace lak
 		bigint &operator=(unsigned value) { return *this = uintmax_t(value); }
 		bigint &operator=(signed value) { return *this = intmax_t(value); }
 
+		std::string to_string(
+		  lak::numeric_base base = lak::numeric_base::dec) const;
+
 		lak::result<uintmax_t> to_uintmax() const;
 		lak::result<intmax_t> to_intmax() const;
 		double to_double() const;
@@ -259,23 +275,18 @@ namespace lak
 
 		friend std::ostream &operator<<(std::ostream &strm, const lak::bigint &val)
 		{
-			const auto old_width = strm.width();
-			DEFER(strm.width(old_width));
-			const auto old_base = strm.flags(std::ostream::basefield);
-			DEFER(strm.setf(old_base, std::ostream::basefield));
-
-			strm << (val.is_negative() ? '-' : '+');
-			strm << std::hex << std::setfill('0');
-
-			for (size_t i = val._data.size(); i-- > 0U;)
+			switch (strm.flags() & std::ostream::basefield)
 			{
-				strm << std::setw(sizeof(uintmax_t) * 2U) << val._data[i];
-				if (i != 0U) strm << '\'';
+				case std::ostream::hex:
+					return strm << val.to_string(lak::numeric_base::hex);
+				case std::ostream::oct:
+					return strm << val.to_string(lak::numeric_base::oct);
+				default: return strm << val.to_string(lak::numeric_base::dec);
 			}
-
-			return strm;
 		}
 	};
 }
 
+void bigint_test();
+
 #endif
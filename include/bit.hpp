@@ -1,4 +1,177 @@
 #ifndef BIT_HPP
 #define BIT_HPP
 
+#include "json.hpp"
+
+#include "lak/result.hpp"
+#include "lak/span.hpp"
+#include "lak/stdint.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+// 7-series configuration frames are 101 32 bit words.
+constexpr size_t words_per_frame = 101U;
+
+struct frame_address
+{
+	enum struct block_type : uint8_t
+	{
+		clb_io_clk = 0,
+		block_ram  = 1,
+		cfg_clb    = 2,
+	};
+
+	block_type block = block_type::clb_io_clk;
+	bool bottom      = false;
+	uint8_t row      = 0U;
+	uint16_t column  = 0U;
+	uint8_t minor    = 0U;
+
+	// [25:23] block type, [22] bottom, [21:17] row, [16:7] column, [6:0] minor
+	uint32_t encode() const;
+	static frame_address decode(uint32_t address);
+
+	// prjxray configuration bus name, e.g. "CLB_IO_CLK".
+	static lak::result<block_type> parse_block_type(lak::astring_view name);
+};
+
+// every configuration frame of a device, in the order the frame address
+// register auto-increments through them. most frames of a design are never
+// written, so frames only get their own page on their first write and every
+// other frame shares the default page.
+struct frame_memory
+{
+	uint32_t idcode = 0U;
+
+	// encoded frame address of each frame.
+	std::vector<uint32_t> addresses;
+	// encoded frame address -> index into addresses.
+	std::unordered_map<uint32_t, uint32_t> address_index;
+
+	static constexpr uint32_t default_page = 0U;
+	// page of each frame, default_page until the frame is first written.
+	std::vector<uint32_t> frame_pages;
+	// words_per_frame words per page, the first page is the default page.
+	std::vector<uint32_t> pages;
+
+	// build the (all zero) frame memory described by a prjxray part.json.
+	static lak::result<frame_memory> from_part(
+	  const json_parser::value_type &part_json);
+
+	size_t frame_count() const { return addresses.size(); }
+
+	// frames that have their own page.
+	size_t written_frame_count() const
+	{
+		return (pages.size() / words_per_frame) - 1U;
+	}
+
+	lak::result<size_t> frame_index(uint32_t address) const;
+
+	bool is_default(size_t index) const
+	{
+		return frame_pages[index] == default_page;
+	}
+
+	lak::span<const uint32_t> default_frame() const
+	{
+		return lak::span<const uint32_t>(pages.data(), words_per_frame);
+	}
+
+	lak::span<const uint32_t> frame(size_t index) const
+	{
+		return lak::span<const uint32_t>(
+		  pages.data() + (size_t(frame_pages[index]) * words_per_frame),
+		  words_per_frame);
+	}
+
+	// gives the frame its own page (a copy of the default page) if it doesn't
+	// have one yet. the span is invalidated by the next write_frame.
+	lak::span<uint32_t> write_frame(size_t index);
+
+	void set_bit(size_t index, size_t word, size_t bit, bool value)
+	{
+		uint32_t &w = write_frame(index)[word];
+		w           = (w & ~(uint32_t(1U) << bit)) | (uint32_t(value) << bit);
+	}
+};
+
+// bit writes gathered while resolving features, applied to the frame memory
+// frame by frame instead of one bit at a time in FASM order.
+struct frame_edits
+{
+	struct edit
+	{
+		uint32_t frame; // index into frame_memory
+		uint16_t bit;   // word * 32 + bit within the word
+		uint16_t value;
+	};
+	std::vector<edit> edits;
+
+	void set(size_t frame, size_t word, size_t bit, bool value)
+	{
+		edits.push_back({.frame = uint32_t(frame),
+		                 .bit   = uint16_t((word * 32U) + bit),
+		                 .value = uint16_t(value)});
+	}
+
+	// buckets the edits by frame, keeping their order within each frame so the
+	// last write to a bit wins, then applies each touched frame as word wide
+	// set and clear masks. clears edits.
+	void apply(frame_memory &frames);
+};
+
+// 7-series configuration CRC step (CRC-32C over 5 address + 32 data bits).
+uint32_t config_crc(uint32_t crc, uint32_t address, uint32_t data);
+
+// 7-series frame ECC, stored in the low 13 bits of word 50.
+uint32_t frame_ecc(lak::span<const uint32_t> frame);
+
+// serialise the frame memory as a configuration packet stream.
+std::vector<uint8_t> write_bitstream(const frame_memory &frames);
+
+// serialise the frame memory, writing each set of identical frames once and
+// replicating it with multiple frame writes (MFWR).
+std::vector<uint8_t> write_compressed_bitstream(const frame_memory &frames);
+
+// a bitstream read back into a frame memory, along with where each frame's
+// data and each CRC check sit in it so frames can be rewritten in place.
+struct bitstream_image
+{
+	static constexpr size_t no_offset = SIZE_MAX;
+
+	std::vector<uint8_t> bytes;
+
+	// byte offset of each frame's data, no_offset unless the frame was written
+	// exactly once by an FDRI write (frames replicated with MFWR aren't).
+	std::vector<size_t> frame_offsets;
+	// how many words had gone through the CRC before each frame's first word.
+	std::vector<uint64_t> frame_steps;
+
+	// CRC checks and resets in stream order, a reset has no_offset.
+	struct crc_event
+	{
+		uint64_t step; // words through the CRC before the event
+		size_t offset; // of the CRC word
+	};
+	std::vector<crc_event> crc_events;
+};
+
+// reads a bitstream written by write_bitstream or write_compressed_bitstream
+// into frames, which must be the (untouched) frame memory of the same part.
+// errs if the stream is malformed or its CRC doesn't match.
+lak::result<bitstream_image> read_bitstream(lak::span<const uint8_t> bytes,
+                                            frame_memory &frames);
+
+// rewrites the data of the changed frames in image with their contents in
+// frames and fixes up the CRC checks that follow them. errs, without touching
+// image, if any of them can't be rewritten in place.
+lak::result<lak::monostate> patch_bitstream(
+  bitstream_image &image,
+  const frame_memory &frames,
+  lak::span<const uint32_t> changed);
+
+void bit_test();
+
 #endif
@@ -0,0 +1,153 @@
+#ifndef CHAR_CLASS_HPP
+#define CHAR_CLASS_HPP
+
+#include "lak/stdint.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#elif defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
+// 256 entry character set built at compile time. used as a template
+// parameter so each parser call site becomes a single table lookup.
+struct char_class
+{
+	bool table[256] = {};
+
+	// small sets also keep their members, which lets scan() compare 16/32
+	// bytes at a time instead of looking every byte up in the table.
+	static constexpr size_t max_listed = 8U;
+	bool listed                        = false;
+	size_t listed_count                = 0U;
+	char listed_chars[max_listed]      = {};
+
+	constexpr bool contains(char c) const { return table[uint8_t(c)]; }
+
+	template<size_t N>
+	static constexpr char_class of(const char (&chars)[N])
+	{
+		char_class result;
+		for (size_t i = 0U; i + 1U < N; ++i)
+			result.table[uint8_t(chars[i])] = true;
+		if (N - 1U <= max_listed)
+		{
+			result.listed       = true;
+			result.listed_count = N - 1U;
+			std::copy(chars, chars + (N - 1U), result.listed_chars);
+		}
+		return result;
+	}
+
+	static constexpr char_class range(char first, char last)
+	{
+		char_class result;
+		for (int c = uint8_t(first); c <= uint8_t(last); ++c)
+			result.table[c] = true;
+		return result;
+	}
+
+	constexpr char_class operator|(const char_class &rhs) const
+	{
+		char_class result;
+		for (size_t i = 0U; i < 256U; ++i)
+			result.table[i] = table[i] || rhs.table[i];
+		if (listed && rhs.listed && listed_count + rhs.listed_count <= max_listed)
+		{
+			result.listed       = true;
+			result.listed_count = listed_count + rhs.listed_count;
+			std::copy(
+			  listed_chars, listed_chars + listed_count, result.listed_chars);
+			std::copy(rhs.listed_chars,
+			          rhs.listed_chars + rhs.listed_count,
+			          result.listed_chars + listed_count);
+		}
+		return result;
+	}
+};
+
+namespace char_classes
+{
+	inline constexpr char_class lower = char_class::range('a', 'z');
+	inline constexpr char_class upper = char_class::range('A', 'Z');
+	inline constexpr char_class digit = char_class::range('0', '9');
+	inline constexpr char_class alnum = lower | upper | digit;
+
+	inline constexpr char_class identifier = alnum | char_class::of("_");
+
+	inline constexpr char_class bin_digit = char_class::range('0', '1');
+	inline constexpr char_class oct_digit = char_class::range('0', '7');
+	inline constexpr char_class dec_digit = digit;
+	inline constexpr char_class hex_digit =
+	  digit | char_class::range('a', 'f') | char_class::range('A', 'F');
+
+	inline constexpr char_class blank      = char_class::of(" \t");
+	inline constexpr char_class newline    = char_class::of("\n\r");
+	inline constexpr char_class whitespace = blank | newline;
+
+	// ends the unescaped run of a quoted string.
+	inline constexpr char_class string_delimiter = char_class::of("\\\"");
+
+	// punctuation spelled inline, e.g. pop_char<char_classes::one_of<'.'>>().
+	template<char... C>
+	inline constexpr char_class one_of = []
+	{
+		const char chars[] = {C..., '\0'};
+		return char_class::of(chars);
+	}();
+}
+
+// value of a hex (or lower base) digit, only valid for hex_digit characters.
+constexpr unsigned digit_value(char c)
+{
+	if (c >= 'a') return unsigned(c - 'a') + 0xAU;
+	if (c >= 'A') return unsigned(c - 'A') + 0xAU;
+	return unsigned(c - '0');
+}
+
+// first character in [begin, end) that is (MATCH) or is not (!MATCH) in
+// CLASS.
+template<bool MATCH, const char_class &CLASS>
+const char *scan(const char *begin, const char *end)
+{
+	if constexpr (CLASS.listed)
+	{
+#if defined(__AVX2__)
+		for (; end - begin >= 32; begin += 32)
+		{
+			const __m256i block =
+			  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+			__m256i found = _mm256_setzero_si256();
+			for (size_t i = 0U; i < CLASS.listed_count; ++i)
+				found = _mm256_or_si256(
+				  found,
+				  _mm256_cmpeq_epi8(block, _mm256_set1_epi8(CLASS.listed_chars[i])));
+			uint32_t mask = uint32_t(_mm256_movemask_epi8(found));
+			if constexpr (!MATCH) mask = ~mask;
+			if (mask != 0U) return begin + std::countr_zero(mask);
+		}
+#endif
+#if defined(__SSE2__)
+		for (; end - begin >= 16; begin += 16)
+		{
+			const __m128i block =
+			  _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+			__m128i found = _mm_setzero_si128();
+			for (size_t i = 0U; i < CLASS.listed_count; ++i)
+				found = _mm_or_si128(
+				  found, _mm_cmpeq_epi8(block, _mm_set1_epi8(CLASS.listed_chars[i])));
+			uint32_t mask = uint32_t(_mm_movemask_epi8(found));
+			if constexpr (!MATCH) mask = ~mask & 0xFFFFU;
+			if (mask != 0U) return begin + std::countr_zero(mask);
+		}
+#endif
+	}
+
+	while (begin != end && CLASS.contains(*begin) != MATCH) ++begin;
+	return begin;
+}
+
+#endif
@@ -1,7 +1,16 @@
 #ifndef DATABASE_HPP
 #define DATABASE_HPP
 
+#include "bit.hpp"
+#include "fasm.hpp"
+#include "fasm2bit.hpp"
+#include "segbits.hpp"
+#include "symbol_table.hpp"
+#include "thread_pool.hpp"
+
+#include "lak/optional.hpp"
 #include "lak/result.hpp"
+#include "lak/string.hpp"
 #include "lak/string_view.hpp"
 
 #include <filesystem>
@@ -10,12 +19,364 @@
 
 namespace fs = std::filesystem;
 
+// the bits of one tile type (on one configuration bus). a flat open
+// addressing map from interned feature name (without the tile type prefix) to
+// a [begin, end) range of one contiguous bits array.
+struct tile_segbits
+{
+	struct entry
+	{
+		symbol_id feature = empty_entry;
+		uint32_t begin    = 0U;
+		uint32_t end      = 0U;
+	};
+	static constexpr symbol_id empty_entry = UINT32_MAX;
+
+	// power of 2 sized, at most half full.
+	std::vector<entry> entries;
+	std::vector<segbit> bits;
+	size_t feature_count = 0U;
+
+	// FEATURE[n] features keyed by (FEATURE, n) as well, so FEATURE[hi:lo]
+	// doesn't have to build and look up the name of every bit.
+	struct indexed_entry
+	{
+		symbol_id base    = empty_entry;
+		uint32_t index    = 0U;
+		symbol_id feature = 0U;
+	};
+	// power of 2 sized, at most half full.
+	std::vector<indexed_entry> indexed_entries;
+	size_t indexed_count = 0U;
+
+	// replaces the bits of feature if it was already inserted.
+	void insert(symbol_id feature, lak::span<const segbit> feature_bits);
+
+	// feature (already inserted) is bit index of base.
+	void insert_indexed(symbol_id base, uint32_t index, symbol_id feature);
+
+	// err if the tile type has no such feature.
+	lak::result<lak::span<const segbit>> find(symbol_id feature) const;
+	lak::result<lak::span<const segbit>> find(symbol_id base,
+	                                          uint32_t index) const;
+
+private:
+	size_t probe(symbol_id feature) const;
+	size_t probe_indexed(symbol_id base, uint32_t index) const;
+	void rehash(size_t entry_count);
+	void rehash_indexed(size_t entry_count);
+};
+
+// where a tile's bits live on one configuration bus.
+struct tile_bus
+{
+	frame_address::block_type block;
+	uint32_t base_address;
+	uint32_t frame_count;
+	uint32_t word_offset;
+	uint32_t word_count;
+};
+
+using tile_id = uint32_t;
+
+// every tile of the device as parallel arrays indexed by dense tile id, with
+// a hashed name -> id index. resolving the tile of a feature is one probe
+// plus a few array loads.
+struct tilegrid
+{
+	static constexpr size_t block_type_count = 3U;
+
+	// interned names and tile types.
+	std::vector<symbol_id> names;
+	std::vector<symbol_id> types;
+	// dense index of each tile's type, into the type_ columns.
+	std::vector<uint32_t> type_indices;
+	std::vector<uint32_t> grid_x;
+	std::vector<uint32_t> grid_y;
+	// bit n set if the tile has bits on block type n.
+	std::vector<uint8_t> bus_masks;
+
+	struct bus_columns
+	{
+		std::vector<uint32_t> base_address;
+		std::vector<uint32_t> frame_count;
+		std::vector<uint32_t> word_offset;
+		std::vector<uint32_t> word_count;
+	};
+	// indexed by block type, then tile id.
+	bus_columns buses[block_type_count];
+
+	// interned name of each tile type.
+	std::vector<symbol_id> type_names;
+	// segbits of each tile type, indexed by block type then type index. set
+	// by database the first time a tile of the type is resolved, bit n of
+	// type_segbits_set is set once block type n has been.
+	std::vector<const tile_segbits *> type_segbits[block_type_count];
+	std::vector<uint8_t> type_segbits_set;
+
+	size_t size() const { return names.size(); }
+
+	void reserve(size_t tile_count);
+
+	// a tile with no buses. replaces (and keeps the id of) an existing tile
+	// with the same name.
+	tile_id insert(symbol_id name, symbol_id type, uint32_t x, uint32_t y);
+
+	void set_bus(tile_id tile, const tile_bus &bus);
+
+	// empty if the tile has no bits on block.
+	lak::optional<tile_bus> bus(tile_id tile,
+	                            frame_address::block_type block) const;
+
+	lak::optional<tile_id> find(symbol_id name) const;
+	lak::optional<tile_id> find(lak::astring_view name) const;
+
+private:
+	struct index_entry
+	{
+		symbol_id name = empty_entry;
+		tile_id tile   = 0U;
+	};
+	static constexpr symbol_id empty_entry = UINT32_MAX;
+
+	// power of 2 sized, at most half full.
+	std::vector<index_entry> _index;
+	// tile type name -> type index.
+	std::unordered_map<symbol_id, uint32_t> _type_index;
+
+	uint32_t type_index(symbol_id type);
+	size_t probe(symbol_id name) const;
+	void rehash(size_t entry_count);
+};
+
+// on disk layout of the --build-cache file. every reference is an offset or
+// index, so the sections are viewed in the mapping without being parsed,
+// but not used in place: the symbols are copied into the symbol table, the
+// tiles and buses are inserted into a tilegrid and each segbits file is
+// rebuilt into a tile_segbits when it's first loaded. what the cache saves
+// is the text parsing and hashing, not the building of those structures.
+//
+// only the header (which holds the section table) is checksummed up front.
+// the sections needed to open the cache are checked when it's opened, the
+// features and bits of each segbits file when that file is first loaded.
+struct database_cache
+{
+	static constexpr char magic[8]    = {'F', '2', 'B', 'C', 'A', 'C', 'H', 'E'};
+	static constexpr uint32_t version = 4U;
+
+	struct section
+	{
+		uint64_t offset;   // from the start of the file
+		uint64_t count;    // number of records
+		uint64_t checksum; // of the records, 0 for features and bits
+	};
+
+	struct string_ref
+	{
+		uint32_t offset; // into the strings section
+		uint32_t size;
+	};
+
+	struct header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+		uint64_t file_size;
+		uint64_t fingerprint; // of the database source files
+		uint64_t checksum;    // of the header, with this field zeroed
+		section strings;
+		section symbols;
+		section tiles;
+		section buses;
+		section segbits_files;
+		section features;
+		section bits;
+	};
+
+	// every name the tiles and features refer to, with its hash, so the
+	// symbol table can adopt them without hashing every string again.
+	struct symbol_record
+	{
+		string_ref name;
+		uint64_t hash; // symbol_hash(name)
+	};
+
+	using symbol_index = uint32_t; // into the symbols section
+
+	struct tile_record
+	{
+		symbol_index name;
+		symbol_index type;
+		uint32_t grid_x;
+		uint32_t grid_y;
+		uint32_t bus_begin;
+		uint32_t bus_count;
+	};
+
+	struct bus_record
+	{
+		uint32_t block;
+		uint32_t base_address;
+		uint32_t frame_count;
+		uint32_t word_offset;
+		uint32_t word_count;
+	};
+
+	struct segbits_record
+	{
+		string_ref key;
+		uint32_t feature_begin;
+		uint32_t feature_count;
+		// the bits of every feature of the file.
+		uint32_t bit_begin;
+		uint32_t bit_count;
+		uint64_t checksum; // of the file's feature and bit records
+	};
+
+	struct feature_record
+	{
+		symbol_index name;
+		uint32_t bit_begin;
+		uint32_t bit_count;
+	};
+
+	struct bit_record
+	{
+		uint32_t packed; // segbit::packed
+	};
+
+	lak::span<const char> strings;
+	lak::span<const symbol_record> symbols;
+	lak::span<const tile_record> tiles;
+	lak::span<const bus_record> buses;
+	lak::span<const segbits_record> segbits_files;
+	lak::span<const feature_record> features;
+	lak::span<const bit_record> bits;
+
+	// symbol_table::global() id of each record in symbols.
+	std::vector<symbol_id> symbol_ids;
+
+	// validates the header, fingerprint and the checksums of the sections
+	// other than features and bits, and adopts the symbol table.
+	static lak::result<database_cache> view(lak::span<const char> file,
+	                                        uint64_t fingerprint);
+
+	lak::result<lak::astring_view> string(string_ref ref) const;
+	lak::result<symbol_id> symbol(symbol_index index) const;
+
+	lak::result<tilegrid> load_tilegrid() const;
+	lak::result<tile_segbits> load_segbits(const segbits_record &record) const;
+};
+
 struct database
 {
+	// from tilegrid.json.
+	tilegrid tiles;
+
+	struct segbits_file
+	{
+		fs::path path;
+		// loaded from the cache instead of path when set.
+		const database_cache::segbits_record *cached = nullptr;
+		bool loaded                                  = false;
+		tile_segbits segbits;
+	};
+	// "TILE_TYPE" or "TILE_TYPE.BUS" -> segbits_*.db file. the files are only
+	// parsed the first time the tile type is looked up.
+	std::unordered_map<lak::astring, segbits_file> segbits_files;
+
+	fs::path tilegrid_path;
+
+	// hash of the paths, sizes and modification times of the source files.
+	uint64_t fingerprint = 0U;
+
+	// empty unless open_cache succeeded.
+	mapped_file cache_file;
+	database_cache cache;
+
+	// lists the segbits files and fingerprints the source files, nothing is
+	// read yet. the tilegrid and each segbits file can then be loaded
+	// independently of each other.
+	static lak::result<database> index(const fs::path &path,
+	                                   lak::astring_view family,
+	                                   lak::astring_view fabric);
+
+	// index and load_tilegrid.
 	static lak::result<database> open(const fs::path &path,
 	                                  lak::astring_view family,
-	                                  lak::astring_view fabric,
-	                                  lak::astring_view package);
+	                                  lak::astring_view fabric);
+
+	// takes the tilegrid and segbits from the cache from here on. errs,
+	// without touching the database, if the cache is missing, corrupt or out
+	// of date with respect to the indexed source files.
+	lak::result<lak::monostate> open_cache(const fs::path &cache_path);
+
+	// from the cache if one is open, otherwise (or if the cache's tilegrid is
+	// corrupt) from tilegrid.json.
+	lak::result<lak::monostate> load_tilegrid();
+
+	// loads every tile type's segbits and writes them and the tilegrid to
+	// cache_path.
+	lak::result<lak::monostate> write_cache(const fs::path &cache_path,
+	                                        thread_pool &pool);
+
+	// adds a task per segbits file not loaded yet. the tasks only touch their
+	// own segbits_file, so they can run alongside load_tilegrid.
+	void add_segbits_loads(
+	  task_graph &graph,
+	  std::initializer_list<task_graph::task_id> dependencies = {});
+
+	// loads the segbits of every tile type not loaded yet, one task per file.
+	lak::result<lak::monostate> load_all_segbits(thread_pool &pool);
+
+	// nullptr if the database has no bits for the tile type on this bus.
+	// not thread safe, the first lookup of a tile type loads its segbits.
+	lak::result<const tile_segbits *> segbits(
+	  lak::astring_view tile_type, frame_address::block_type block);
+
+	// looks up the bits a FASM feature sets and queues them in edits. errs
+	// on unknown tiles and malformed values, features the database has no
+	// bits for are skipped with a warning.
+	lak::result<lak::monostate> resolve(
+	  const fasm_parser::fasm_feature &feature,
+	  const frame_memory &frames,
+	  frame_edits &edits);
+
+	// clears every bit the tile owns on every bus and appends the frames it
+	// spans to touched. errs on unknown tiles.
+	lak::result<lak::monostate> clear_tile(symbol_id tile_name,
+	                                       frame_memory &frames,
+	                                       std::vector<uint32_t> &touched) const;
+
+	// assembles lines on top of frames, which must already hold base_lines
+	// assembled, by clearing and resolving again only the tiles whose features
+	// differ from base_lines and the tiles sharing words with them. appends
+	// the frames it rewrites, sorted, to touched. returns how many tiles were
+	// reassembled. errs on unknown tiles.
+	lak::result<size_t> assemble_changes(
+	  lak::span<const fasm_parser::line> base_lines,
+	  lak::span<const fasm_parser::line> lines,
+	  frame_memory &frames,
+	  std::vector<uint32_t> &touched);
+
+private:
+	lak::result<lak::monostate> load_file(segbits_file &file);
+
+	// nullptr if the tile's type has no bits on block. the segbits are
+	// looked up (and loaded) once per tile type.
+	lak::result<const tile_segbits *> tile_type_segbits(
+	  tile_id tile, frame_address::block_type block);
+
+	// false if no segbits file of the tile's type has the feature, or bit
+	// index of it if index is set.
+	lak::result<bool> resolve_bits(tile_id tile,
+	                               symbol_id feature,
+	                               lak::optional<uint32_t> index,
+	                               const frame_memory &frames,
+	                               frame_edits &edits);
 };
 
+void database_test();
+
 #endif
@@ -3,12 +3,15 @@
 
 #include "bigint.hpp"
 #include "parser.hpp"
+#include "symbol_table.hpp"
+#include "thread_pool.hpp"
 
 #include "lak/optional.hpp"
 #include "lak/result.hpp"
 #include "lak/stdint.hpp"
 #include "lak/string_view.hpp"
 #include "lak/tuple.hpp"
+#include "lak/variant.hpp"
 
 #include <ostream>
 
@@ -19,10 +22,16 @@ struct fasm_parser : public basic_parser
 	result<lak::astring_view> parse_identifier();
 	result<std::vector<lak::astring_view>> parse_feature();
 
-	result<lak::bigint> parse_dec_value();
-	result<lak::bigint> parse_hex_value();
-	result<lak::bigint> parse_oct_value();
-	result<lak::bigint> parse_bin_value();
+	// almost every value in a FASM file fits in a uintmax_t, only promote to a
+	// lak::bigint for the few that don't.
+	using integer = lak::variant<uintmax_t, lak::bigint>;
+
+	static result<uintmax_t> to_uintmax(const integer &value);
+
+	result<integer> parse_dec_value();
+	result<integer> parse_hex_value();
+	result<integer> parse_oct_value();
+	result<integer> parse_bin_value();
 
 	result<uint8_t> parse_value_base();
 	result<uintmax_t> parse_verilog_value_width();
@@ -30,7 +39,7 @@ struct fasm_parser : public basic_parser
 	struct verilog_value
 	{
 		lak::optional<uintmax_t> width;
-		lak::bigint value;
+		integer value;
 	};
 	result<verilog_value> parse_verilog_value();
 
@@ -56,9 +65,17 @@ struct fasm_parser : public basic_parser
 	struct fasm_feature
 	{
 		std::vector<lak::astring_view> feature;
+		// the whole dotted name, a view into the input.
+		lak::astring_view name;
+		// ids in symbol_table::global() of the tile name and everything after
+		// it (the segbits feature name).
+		symbol_id tile_id   = 0U;
+		symbol_id suffix_id = 0U;
 		lak::optional<feature_address> address;
 		lak::optional<verilog_value> value;
 	};
+	// interns the tile and feature names of parse_set_feature.
+	symbol_cache symbols{symbol_table::global()};
 	result<fasm_feature> parse_set_feature();
 
 	struct line
@@ -68,9 +85,50 @@ struct fasm_parser : public basic_parser
 		lak::astring_view comment;
 	};
 	result<line> parse_line();
+
+	// parses a single line and the newline(s) that follow it, returns an empty
+	// optional once the input has been exhausted.
+	result<lak::optional<line>> parse_next_line();
+
+	// streams each line to func as it is parsed, so memory use is independent
+	// of the length of the input.
+	template<typename FUNC>
+	result<> parse(FUNC &&func)
+	{
+		for (;;)
+		{
+			RES_TRY_ASSIGN(lak::optional<line> l =, parse_next_line());
+			if (!l) return lak::ok_t{};
+			func(lak::move(*l));
+		}
+	}
+
 	result<std::vector<line>> parse();
+
+	struct line_error
+	{
+		error_type error;
+		size_t line_number; // 1 based
+	};
+
+	// convert an error at position within file into a line_error.
+	static line_error make_line_error(lak::astring_view file,
+	                                  const char *position,
+	                                  error_type error);
+
+	// not worth a task for less than this.
+	static constexpr size_t default_min_chunk_size = 0x10000U;
+
+	// splits the input at newline boundaries into a chunk per job of pool and
+	// parses each chunk as a task. the lines are returned in file order and
+	// errors report their line number within the whole input.
+	lak::result<std::vector<line>, line_error> parse_parallel(
+	  thread_pool &pool, size_t min_chunk_size = default_min_chunk_size);
 };
 
+std::ostream &operator<<(std::ostream &strm,
+                         const fasm_parser::integer &value);
+
 std::ostream &operator<<(std::ostream &strm,
                          const fasm_parser::verilog_value &value);
 
@@ -85,6 +143,9 @@ std::ostream &operator<<(std::ostream &strm,
 
 std::ostream &operator<<(std::ostream &strm, const fasm_parser::line &value);
 
+std::ostream &operator<<(std::ostream &strm,
+                         const fasm_parser::line_error &value);
+
 void fasm_test();
 
 #endif
@@ -3,7 +3,9 @@
 
 #include "lak/debug.hpp"
 #include "lak/errno_result.hpp"
+#include "lak/span.hpp"
 #include "lak/string_literals.hpp"
+#include "lak/string_view.hpp"
 
 #include <filesystem>
 #include <vector>
@@ -14,6 +16,38 @@ extern const lak::astring_view help_string;
 
 lak::errno_result<std::vector<char>> read_file(const fs::path &path);
 
+lak::errno_result<lak::monostate> write_file(const fs::path &path,
+                                             lak::span<const uint8_t> data);
+
+// read only view of a file, memory mapped where the platform supports it and
+// read into memory otherwise.
+struct mapped_file
+{
+	mapped_file() = default;
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+	mapped_file(mapped_file &&other);
+	mapped_file &operator=(mapped_file &&other);
+	~mapped_file();
+
+	lak::span<const char> data() const { return lak::span(_data, _size); }
+	lak::astring_view view() const { return lak::astring_view(data()); }
+	size_t size() const { return _size; }
+	bool empty() const { return _size == 0U; }
+
+private:
+	friend lak::errno_result<mapped_file> map_file(const fs::path &path);
+
+	const char *_data = nullptr;
+	size_t _size      = 0U;
+	bool _mapped      = false;
+	std::vector<char> _buffer;
+
+	void reset();
+};
+
+lak::errno_result<mapped_file> map_file(const fs::path &path);
+
 inline int user_error(const auto &...ars)
 {
 	lak::debugger.std_err(u8"" LAK_RED "ERROR: " LAK_SGR_RESET ""_str,
@@ -21,6 +55,12 @@ inline int user_error(const auto &...ars)
 	return EXIT_FAILURE;
 }
 
+inline void user_warning(const auto &...ars)
+{
+	lak::debugger.std_err(u8"" LAK_YELLOW "WARNING: " LAK_SGR_RESET ""_str,
+	                      lak::streamify(ars..., "\n"));
+}
+
 inline int user_error_cont(const auto &...ars)
 {
 	lak::debugger.std_err_cont(lak::streamify(ars..., "\n"));
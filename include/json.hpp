@@ -1,22 +1,31 @@
 #ifndef JSON_HPP
 #define JSON_HPP
 
+#include "arena.hpp"
 #include "parser.hpp"
 
 #include "lak/result.hpp"
 #include "lak/string_view.hpp"
 
+#include <vector>
+
 struct json_parser : public basic_parser
 {
 	struct value_type;
 	struct key_value;
+	// arrays and objects point into the document's arena rather than owning
+	// their children, so building and freeing the tree costs a handful of
+	// block allocations instead of one per node.
 	struct array
 	{
-		std::vector<value_type> values;
+		lak::span<const value_type> values;
 	};
 	struct object
 	{
-		std::vector<key_value> key_values;
+		lak::span<const key_value> key_values;
+
+		// first value with key, nullptr if there is none.
+		inline const value_type *find(lak::astring_view key) const;
 	};
 	struct string
 	{
@@ -46,6 +55,20 @@ struct json_parser : public basic_parser
 		value_type value;
 	};
 
+	// a parsed tree, root and everything below it lives in nodes.
+	struct document
+	{
+		lak::arena nodes;
+		value_type root;
+	};
+
+	// receives the children of every array and object parsed.
+	lak::arena nodes;
+	// children of the arrays/objects still being parsed, moved into nodes
+	// when each one is closed.
+	std::vector<value_type> value_stack;
+	std::vector<key_value> key_value_stack;
+
 	lak::astring_view parse_whitespace();
 
 	result<string> parse_string();
@@ -59,9 +82,86 @@ struct json_parser : public basic_parser
 
 	result<value_type> parse_value();
 
-	result<value_type> parse();
+	// parse a whole document, moving nodes into it.
+	result<document> parse();
+
+	// event (SAX style) interface, walks the input calling
+	//   handler.start_object() / handler.end_object()
+	//   handler.start_array() / handler.end_array()
+	//   handler.key(lak::astring_view)
+	//   handler.string(lak::astring_view)
+	//   handler.literal(lak::astring_view) (numbers, true, false and null)
+	// as each token is parsed, without building a tree. strings and keys are
+	// passed as they appear in the input (still escaped).
+	template<typename HANDLER>
+	result<> parse_events(HANDLER &handler)
+	{
+		parse_whitespace();
+		return parse_value_events(handler);
+	}
+
+	template<typename HANDLER>
+	result<> parse_value_events(HANDLER &handler);
 };
 
+template<typename HANDLER>
+json_parser::result<> json_parser::parse_value_events(HANDLER &handler)
+{
+	if (peek_char<char_classes::one_of<'"'>>().is_ok())
+	{
+		RES_TRY_ASSIGN(const string str =, parse_string());
+		handler.string(str.value);
+	}
+	else if (pop_char<char_classes::one_of<'{'>>().is_ok())
+	{
+		handler.start_object();
+		parse_whitespace();
+		while (peek_char<char_classes::one_of<'}'>>().is_err())
+		{
+			RES_TRY_ASSIGN(const string key =, parse_string());
+			handler.key(key.value);
+			parse_whitespace();
+			pop_char<char_classes::one_of<':'>>().discard();
+			parse_whitespace();
+			RES_TRY(parse_value_events(handler));
+			parse_whitespace();
+			if (pop_char<char_classes::one_of<','>>().is_err()) break;
+			parse_whitespace();
+		}
+		RES_TRY(pop_char<char_classes::one_of<'}'>>());
+		handler.end_object();
+	}
+	else if (pop_char<char_classes::one_of<'['>>().is_ok())
+	{
+		handler.start_array();
+		parse_whitespace();
+		while (peek_char<char_classes::one_of<']'>>().is_err())
+		{
+			RES_TRY(parse_value_events(handler));
+			parse_whitespace();
+			if (pop_char<char_classes::one_of<','>>().is_err()) break;
+			parse_whitespace();
+		}
+		RES_TRY(pop_char<char_classes::one_of<']'>>());
+		handler.end_array();
+	}
+	else
+	{
+		RES_TRY_ASSIGN(const lak::astring_view literal =, parse_literal());
+		handler.literal(literal);
+	}
+
+	return lak::ok_t{};
+}
+
+inline const json_parser::value_type *json_parser::object::find(
+  lak::astring_view key) const
+{
+	for (const auto &kv : key_values)
+		if (kv.key.value == key) return &kv.value;
+	return nullptr;
+}
+
 std::ostream &operator<<(std::ostream &strm,
                          const json_parser::value_type &value);
 
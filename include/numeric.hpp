@@ -118,6 +118,15 @@ namespace lak
 	                             uintmax_t B,
 	                             uintmax_t C); // A - (B + (~C + 1))
 	lak::uintmax2_t mul_uintmax2(uintmax_t A, uintmax_t B);
+
+	struct uintmax_div_rem_t
+	{
+		uintmax_t quotient;
+		uintmax_t remainder;
+	};
+
+	// (A.high:A.low) / B, A.high must be less than B so the quotient fits.
+	lak::uintmax_div_rem_t div_uintmax2(lak::uintmax2_t A, uintmax_t B);
 }
 
 #endif
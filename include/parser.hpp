@@ -1,6 +1,8 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include "char_class.hpp"
+
 #include "lak/result.hpp"
 #include "lak/string_view.hpp"
 
@@ -23,14 +25,64 @@ struct basic_parser
 	result<char> peek() const;
 	result<char> pop();
 
-	result<char> peek_char(std::initializer_list<char> c);
-	result<char> pop_char(std::initializer_list<char> c);
-
-	result<char> peek_not_char(std::initializer_list<char> c);
-	result<char> pop_not_char(std::initializer_list<char> c);
-
 	result<lak::astring_view> peek_string(lak::astring_view str);
 	result<lak::astring_view> pop_string(lak::astring_view str);
+
+	// CLASS is one of char_classes.
+	template<const char_class &CLASS>
+	result<char> peek_char() const
+	{
+		if (input.empty()) return lak::err_t{error_type::end_of_file};
+		if (!CLASS.contains(input[0]))
+			return lak::err_t{error_type::unexpected_character};
+		return lak::ok_t{input[0]};
+	}
+
+	template<const char_class &CLASS>
+	result<char> pop_char()
+	{
+		RES_TRY_ASSIGN(const char c =, peek_char<CLASS>());
+		input = input.substr(1);
+		return lak::ok_t{c};
+	}
+
+	template<const char_class &CLASS>
+	result<char> peek_not_char() const
+	{
+		if (input.empty()) return lak::err_t{error_type::end_of_file};
+		if (CLASS.contains(input[0]))
+			return lak::err_t{error_type::unexpected_character};
+		return lak::ok_t{input[0]};
+	}
+
+	template<const char_class &CLASS>
+	result<char> pop_not_char()
+	{
+		RES_TRY_ASSIGN(const char c =, peek_not_char<CLASS>());
+		input = input.substr(1);
+		return lak::ok_t{c};
+	}
+
+	// advance up to the first character in CLASS (or the end of the input),
+	// returns the skipped input.
+	template<const char_class &CLASS>
+	lak::astring_view skip_until()
+	{
+		const char *begin = input.begin();
+		const char *end   = scan<true, CLASS>(begin, input.end());
+		input             = lak::astring_view(end, input.end());
+		return lak::astring_view(begin, end);
+	}
+
+	// advance past the run of characters in CLASS, returns the skipped input.
+	template<const char_class &CLASS>
+	lak::astring_view skip_while()
+	{
+		const char *begin = input.begin();
+		const char *end   = scan<false, CLASS>(begin, input.end());
+		input             = lak::astring_view(end, input.end());
+		return lak::astring_view(begin, end);
+	}
 };
 
 std::ostream &operator<<(std::ostream &strm,
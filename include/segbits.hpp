@@ -0,0 +1,76 @@
+#ifndef SEGBITS_HPP
+#define SEGBITS_HPP
+
+#include "parser.hpp"
+
+#include "lak/result.hpp"
+#include "lak/stdint.hpp"
+#include "lak/string_view.hpp"
+
+#include <vector>
+
+// one bit of a prjxray segbits_*.db feature, "FF_BB" or "!FF_BB", packed into
+// 32 bits so a tile type's bits are one dense array:
+//   [31]    invert, set for "!" bits that must be cleared
+//   [30:12] frame offset from the tile's base address
+//   [11:5]  word offset from the tile's first word
+//   [4:0]   bit within the word
+struct segbit
+{
+	static constexpr uint32_t max_frame = (1U << 19U) - 1U;
+	static constexpr uint32_t max_bit   = (1U << 12U) - 1U;
+
+	uint32_t packed = 0U;
+
+	// frame and bit must not exceed max_frame and max_bit.
+	static constexpr segbit make(uint32_t frame, uint32_t bit, bool value)
+	{
+		return segbit{(uint32_t(!value) << 31U) | (frame << 12U) | bit};
+	}
+
+	constexpr uint32_t frame() const { return (packed >> 12U) & max_frame; }
+	// bit offset from the tile's first word, word() * 32 + word_bit().
+	constexpr uint32_t bit() const { return packed & max_bit; }
+	constexpr uint32_t word() const { return (packed >> 5U) & 0x7FU; }
+	constexpr uint32_t word_bit() const { return packed & 0x1FU; }
+	constexpr bool value() const { return (packed >> 31U) == 0U; }
+
+	bool operator==(const segbit &) const = default;
+};
+static_assert(sizeof(segbit) == 4U);
+
+struct segbits_parser : public basic_parser
+{
+	struct line
+	{
+		lak::astring_view feature;
+		std::vector<segbit> bits;
+	};
+
+	lak::astring_view parse_whitespace();
+
+	result<uint32_t> parse_uint();
+	result<segbit> parse_bit();
+	result<line> parse_line();
+
+	template<typename FUNC>
+	result<> parse(FUNC &&func)
+	{
+		while (!input.empty())
+		{
+			skip_while<char_classes::whitespace>();
+			if (input.empty()) break;
+			RES_TRY_ASSIGN(line l =, parse_line());
+			func(lak::move(l));
+		}
+		return lak::ok_t{};
+	}
+};
+
+std::ostream &operator<<(std::ostream &strm, const segbit &bit);
+
+std::ostream &operator<<(std::ostream &strm, const segbits_parser::line &line);
+
+void segbits_test();
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef LAK_SMALL_VECTOR_HPP
+#define LAK_SMALL_VECTOR_HPP
+
+#include "lak/span.hpp"
+#include "lak/stdint.hpp"
+#include "lak/utility.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace lak
+{
+	// vector that stores up to N elements inline and only allocates once it
+	// grows beyond that. restricted to trivially copyable types so elements can
+	// be moved around with std::copy.
+	template<typename T, size_t N>
+	struct small_vector
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		static_assert(N > 0U);
+
+		using value_type     = T;
+		using iterator       = T *;
+		using const_iterator = const T *;
+
+	private:
+		T *_data         = _inline;
+		size_t _size     = 0U;
+		size_t _capacity = N;
+		T _inline[N];
+
+		bool is_inline() const { return _data == _inline; }
+
+		void grow(size_t min_capacity)
+		{
+			size_t new_capacity = std::max(_capacity * 2U, min_capacity);
+			T *new_data         = new T[new_capacity];
+			std::copy(_data, _data + _size, new_data);
+			if (!is_inline()) delete[] _data;
+			_data     = new_data;
+			_capacity = new_capacity;
+		}
+
+	public:
+		small_vector() = default;
+
+		small_vector(const small_vector &other) { *this = other; }
+
+		small_vector(small_vector &&other) { *this = lak::move(other); }
+
+		small_vector &operator=(const small_vector &other)
+		{
+			if (this == &other) return *this;
+			_size = 0U;
+			reserve(other._size);
+			std::copy(other._data, other._data + other._size, _data);
+			_size = other._size;
+			return *this;
+		}
+
+		small_vector &operator=(small_vector &&other)
+		{
+			if (this == &other) return *this;
+			if (other.is_inline())
+			{
+				*this = other;
+			}
+			else
+			{
+				if (!is_inline()) delete[] _data;
+				_data           = other._data;
+				_size           = other._size;
+				_capacity       = other._capacity;
+				other._data     = other._inline;
+				other._capacity = N;
+			}
+			other._size = 0U;
+			return *this;
+		}
+
+		~small_vector()
+		{
+			if (!is_inline()) delete[] _data;
+		}
+
+		size_t size() const { return _size; }
+		size_t capacity() const { return _capacity; }
+		bool empty() const { return _size == 0U; }
+
+		T *data() { return _data; }
+		const T *data() const { return _data; }
+
+		T *begin() { return _data; }
+		T *end() { return _data + _size; }
+		const T *begin() const { return _data; }
+		const T *end() const { return _data + _size; }
+
+		T &operator[](size_t index) { return _data[index]; }
+		const T &operator[](size_t index) const { return _data[index]; }
+
+		T &back() { return _data[_size - 1U]; }
+		const T &back() const { return _data[_size - 1U]; }
+
+		lak::span<T> span() { return lak::span<T>(_data, _size); }
+		lak::span<const T> span() const
+		{
+			return lak::span<const T>(_data, _size);
+		}
+
+		void reserve(size_t count)
+		{
+			if (count > _capacity) grow(count);
+		}
+
+		void resize(size_t count, const T &value = T{})
+		{
+			reserve(count);
+			if (count > _size) std::fill(_data + _size, _data + count, value);
+			_size = count;
+		}
+
+		void clear() { _size = 0U; }
+
+		void push_back(const T &value)
+		{
+			if (_size == _capacity) grow(_size + 1U);
+			_data[_size++] = value;
+		}
+
+		void pop_back() { --_size; }
+
+		bool operator==(const small_vector &rhs) const
+		{
+			return std::equal(begin(), end(), rhs.begin(), rhs.end());
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include "lak/optional.hpp"
+#include "lak/span.hpp"
+#include "lak/stdint.hpp"
+#include "lak/string_view.hpp"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+using symbol_id = uint32_t;
+
+// 64 bit FNV-1a, stable across runs and platforms.
+inline uint64_t symbol_hash(lak::astring_view str)
+{
+	uint64_t hash = 0xCBF29CE484222325U;
+	for (const char c : str)
+	{
+		hash ^= uint8_t(c);
+		hash *= 0x100000001B3U;
+	}
+	return hash;
+}
+
+// interns strings as dense ids (0, 1, 2, ...). the strings are copied into an
+// arena so the views returned by name() stay valid for the table's lifetime.
+// all members are thread safe, lookups (including intern of a string that is
+// already in the table) only take a shared lock.
+struct symbol_table
+{
+	symbol_table() = default;
+	symbol_table(const symbol_table &) = delete;
+	symbol_table &operator=(const symbol_table &) = delete;
+
+	symbol_id intern(lak::astring_view str);
+
+	struct entry
+	{
+		lak::astring_view name;
+		uint64_t hash; // symbol_hash(name)
+	};
+
+	// interns distinct strings whose hashes are already known, returns their
+	// ids in order. an empty table hands out 0, 1, 2, ... without hashing or
+	// comparing any strings.
+	std::vector<symbol_id> adopt(lak::span<const entry> entries);
+
+	lak::optional<symbol_id> find(lak::astring_view str) const;
+	lak::astring_view name(symbol_id id) const;
+	size_t size() const;
+
+	// table shared by the FASM parser and the database.
+	static symbol_table &global();
+
+private:
+	struct slot
+	{
+		uint64_t hash;
+		symbol_id id; // empty_slot if unused
+	};
+	static constexpr symbol_id empty_slot      = UINT32_MAX;
+	static constexpr size_t arena_block_size = 0x10000U;
+
+	mutable std::shared_mutex _mutex;
+	// open addressing with linear probing, power of 2 sized.
+	std::vector<slot> _slots;
+	std::vector<lak::astring_view> _names;
+	std::vector<std::unique_ptr<char[]>> _arena;
+	char *_arena_block = nullptr;
+	size_t _arena_used = 0U;
+
+	// must hold _mutex, shared for probe.
+	size_t probe(uint64_t hash, lak::astring_view str) const;
+	lak::astring_view copy_to_arena(lak::astring_view str);
+	void rehash(size_t slot_count);
+};
+
+// a direct mapped cache of recent intern results in front of a table, for
+// one thread to intern the same names over and over (like the tile and
+// feature names of a FASM file) without taking the table's lock or hashing
+// each string a byte at a time. not thread safe, each thread needs its own.
+struct symbol_cache
+{
+	explicit symbol_cache(symbol_table &table) : _table(&table) {}
+
+	symbol_id intern(lak::astring_view str);
+
+private:
+	struct entry
+	{
+		lak::astring_view name; // in the table's arena
+		symbol_id id = empty_entry;
+	};
+	static constexpr symbol_id empty_entry = UINT32_MAX;
+	static constexpr size_t entry_bits     = 13U;
+
+	symbol_table *_table;
+	// 1 << entry_bits entries, allocated by the first intern.
+	std::vector<entry> _entries;
+};
+
+#endif
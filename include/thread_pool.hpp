@@ -0,0 +1,92 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include "lak/result.hpp"
+#include "lak/stdint.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// work stealing pool. every worker has its own deque, it runs its newest
+// task first and steals the oldest task of another worker when it runs dry.
+// a pool of N jobs starts N - 1 threads, the thread waiting on it is the Nth.
+struct thread_pool
+{
+	using task = std::function<void()>;
+
+	explicit thread_pool(size_t job_count);
+	thread_pool(const thread_pool &) = delete;
+	thread_pool &operator=(const thread_pool &) = delete;
+	~thread_pool();
+
+	size_t job_count() const { return _queues.size(); }
+
+	// tasks submitted from a worker go to the front of that worker's deque.
+	void submit(task t);
+
+	// runs tasks on the calling thread until done() returns true. may be
+	// called from inside a task, the caller keeps working rather than
+	// blocking a worker.
+	void wait_until(const std::function<bool()> &done);
+
+private:
+	struct queue
+	{
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+	// one per job, the last belongs to the threads outside of the pool.
+	std::vector<std::unique_ptr<queue>> _queues;
+	std::vector<std::thread> _threads;
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	// tasks sitting in a queue, guarded by _mutex. counts a task from just
+	// before it's pushed until just after it's popped.
+	size_t _queued = 0U;
+	bool _stop     = false;
+
+	size_t this_queue() const;
+	bool run_one(size_t self);
+	void worker(size_t self);
+};
+
+// tasks with dependencies. a task is submitted to the pool once every task
+// it depends on has finished, if any of them failed it is skipped and counts
+// as failed itself.
+struct task_graph
+{
+	using task_id = size_t;
+	using task    = std::function<lak::result<lak::monostate>()>;
+
+	task_id add(task t, std::initializer_list<task_id> dependencies = {});
+
+	// runs every task and waits for all of them, errs if any task failed.
+	lak::result<lak::monostate> run(thread_pool &pool);
+
+private:
+	struct node
+	{
+		task func;
+		std::vector<task_id> dependents;
+		size_t dependency_count = 0U;
+		std::atomic<size_t> remaining;
+		std::atomic<bool> skipped;
+	};
+	// deque so nodes never move, the atomics aren't movable.
+	std::deque<node> _nodes;
+	std::atomic<size_t> _unfinished;
+	std::atomic<bool> _failed;
+
+	void start(thread_pool &pool, task_id id);
+	void finish(thread_pool &pool, task_id id, bool ok);
+};
+
+#endif
@@ -4,13 +4,296 @@
 #include "lak/debug.hpp"
 #include "lak/memmanip.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 bool is_negative(uintmax_t v)
 {
 	return (v & (~(UINTMAX_MAX >> 1U))) != 0U;
 }
 
+/* --- limb kernels --- */
+
+// below this many limbs schoolbook multiplication beats karatsuba.
+static constexpr size_t karatsuba_threshold = 24U;
+
+// above this many limbs decimal conversion splits the value in half by a
+// power of 10 instead of repeatedly dividing the whole value by 10^19.
+static constexpr size_t dec_split_threshold = 32U;
+
+// largest power of 10 that fits in a limb, and the number of digits it covers.
+static constexpr uintmax_t dec_chunk        = 10'000'000'000'000'000'000U;
+static constexpr size_t dec_chunk_digits    = 19U;
+
+// result[0, a_size) = a + b, returns the carry out. a_size >= b_size.
+// result may alias a or b.
+static uintmax_t add_limbs(uintmax_t *result,
+                           const uintmax_t *a,
+                           size_t a_size,
+                           const uintmax_t *b,
+                           size_t b_size)
+{
+	uintmax_t carry = 0U;
+	for (size_t i = 0U; i < b_size; ++i)
+	{
+		const lak::uintmax2_t sum = lak::add_uintmax2(a[i], b[i], carry);
+		result[i]                 = sum.low;
+		carry                     = sum.high;
+	}
+	for (size_t i = b_size; i < a_size; ++i)
+	{
+		const lak::uintmax2_t sum = lak::add_uintmax2(a[i], carry);
+		result[i]                 = sum.low;
+		carry                     = sum.high;
+	}
+	return carry;
+}
+
+// result[0, a_size) = a - b, returns the borrow out. a_size >= b_size.
+// result may alias a or b.
+static uintmax_t sub_limbs(uintmax_t *result,
+                           const uintmax_t *a,
+                           size_t a_size,
+                           const uintmax_t *b,
+                           size_t b_size)
+{
+	uintmax_t borrow = 0U;
+	for (size_t i = 0U; i < b_size; ++i)
+	{
+		const uintmax_t diff = a[i] - b[i];
+		const uintmax_t next = (a[i] < b[i]) | (diff < borrow);
+		result[i]            = diff - borrow;
+		borrow               = next;
+	}
+	for (size_t i = b_size; i < a_size; ++i)
+	{
+		const uintmax_t next = a[i] < borrow;
+		result[i]            = a[i] - borrow;
+		borrow               = next;
+	}
+	return borrow;
+}
+
+// result[0, a_size + b_size) = a * b. result must not alias a or b.
+static void mul_limbs_schoolbook(uintmax_t *result,
+                                 const uintmax_t *a,
+                                 size_t a_size,
+                                 const uintmax_t *b,
+                                 size_t b_size)
+{
+	std::fill(result, result + a_size, uintmax_t(0U));
+	for (size_t j = 0U; j < b_size; ++j)
+	{
+		uintmax_t carry = 0U;
+		for (size_t i = 0U; i < a_size; ++i)
+		{
+			// a * b + c + d <= (2^n - 1)^2 + 2(2^n - 1) < 2^2n, cannot overflow.
+			const lak::uintmax2_t mul = lak::mul_uintmax2(a[i], b[j]);
+			const lak::uintmax2_t sum =
+			  lak::add_uintmax2(mul.low, result[i + j], carry);
+			result[i + j] = sum.low;
+			carry         = mul.high + sum.high;
+		}
+		result[j + a_size] = carry;
+	}
+}
+
+// result[0, a_size + b_size) = a * b. result must not alias a or b.
+static void mul_limbs(uintmax_t *result,
+                      const uintmax_t *a,
+                      size_t a_size,
+                      const uintmax_t *b,
+                      size_t b_size)
+{
+	if (a_size < b_size)
+	{
+		std::swap(a, b);
+		std::swap(a_size, b_size);
+	}
+
+	if (b_size < karatsuba_threshold)
+	{
+		mul_limbs_schoolbook(result, a, a_size, b, b_size);
+		return;
+	}
+
+	if (a_size >= b_size * 2U)
+	{
+		// unbalanced, multiply b_size slices of a by b and accumulate.
+		std::vector<uintmax_t> partial(b_size * 2U);
+		std::fill(result, result + a_size + b_size, uintmax_t(0U));
+		for (size_t offset = 0U; offset < a_size; offset += b_size)
+		{
+			const size_t slice_size = std::min(b_size, a_size - offset);
+			mul_limbs(partial.data(), a + offset, slice_size, b, b_size);
+			const uintmax_t carry = add_limbs(result + offset,
+			                                  result + offset,
+			                                  a_size + b_size - offset,
+			                                  partial.data(),
+			                                  slice_size + b_size);
+			ASSERT_EQUAL(carry, 0U);
+		}
+		return;
+	}
+
+	// karatsuba, with B = 2^(n * half):
+	// a * b = (a1 * B + a0)(b1 * B + b0)
+	//       = z2 * B^2 + (z1 - z2 - z0) * B + z0
+	// z0 = a0 * b0, z2 = a1 * b1, z1 = (a0 + a1)(b0 + b1)
+	const size_t half    = a_size / 2U;
+	const size_t a1_size = a_size - half;
+	const size_t b1_size = b_size - half;
+
+	mul_limbs(result, a, half, b, half);
+	mul_limbs(result + (half * 2U), a + half, a1_size, b + half, b1_size);
+
+	const size_t a_sum_size = a1_size + 1U;
+	const size_t b_sum_size = std::max(half, b1_size) + 1U;
+	const size_t z1_size    = a_sum_size + b_sum_size;
+	std::vector<uintmax_t> scratch(a_sum_size + b_sum_size + z1_size);
+	uintmax_t *a_sum = scratch.data();
+	uintmax_t *b_sum = a_sum + a_sum_size;
+	uintmax_t *z1    = b_sum + b_sum_size;
+
+	a_sum[a_sum_size - 1U] = add_limbs(a_sum, a + half, a1_size, a, half);
+	if (b1_size >= half)
+		b_sum[b_sum_size - 1U] = add_limbs(b_sum, b + half, b1_size, b, half);
+	else
+		b_sum[b_sum_size - 1U] = add_limbs(b_sum, b, half, b + half, b1_size);
+
+	mul_limbs(z1, a_sum, a_sum_size, b_sum, b_sum_size);
+
+	uintmax_t borrow = sub_limbs(z1, z1, z1_size, result, half * 2U);
+	borrow += sub_limbs(
+	  z1, z1, z1_size, result + (half * 2U), a1_size + b1_size);
+	ASSERT_EQUAL(borrow, 0U);
+
+	// z1 - z2 - z0 = a0 * b1 + a1 * b0, which fits in the top of the result.
+	const size_t remaining = a_size + b_size - half;
+	size_t z1_used         = z1_size;
+	while (z1_used > remaining)
+	{
+		ASSERT_EQUAL(z1[z1_used - 1U], 0U);
+		--z1_used;
+	}
+	const uintmax_t carry =
+	  add_limbs(result + half, result + half, remaining, z1, z1_used);
+	ASSERT_EQUAL(carry, 0U);
+}
+
+// u -= q * v over n + 1 limbs of u, returns the borrow out.
+static uintmax_t mul_sub_limbs(uintmax_t *u,
+                               const uintmax_t *v,
+                               size_t n,
+                               uintmax_t q)
+{
+	uintmax_t mul_carry = 0U;
+	uintmax_t borrow    = 0U;
+	for (size_t i = 0U; i < n; ++i)
+	{
+		const lak::uintmax2_t mul = lak::mul_uintmax2(q, v[i]);
+		const lak::uintmax2_t sum = lak::add_uintmax2(mul.low, mul_carry);
+		mul_carry                 = mul.high + sum.high;
+
+		const uintmax_t diff = u[i] - sum.low;
+		const uintmax_t next = (u[i] < sum.low) | (diff < borrow);
+		u[i]                 = diff - borrow;
+		borrow               = next;
+	}
+	const uintmax_t diff = u[n] - mul_carry;
+	const uintmax_t next = (u[n] < mul_carry) | (diff < borrow);
+	u[n]                 = diff - borrow;
+	return next;
+}
+
+// knuth algorithm D (TAOCP vol 2, 4.3.1).
+// quotient[0, u_size - v_size + 1) = u / v, remainder[0, v_size) = u % v.
+// v_size >= 2, u_size >= v_size and the top limb of v must be non-zero.
+static void div_rem_limbs(uintmax_t *quotient,
+                          uintmax_t *remainder,
+                          const uintmax_t *u,
+                          size_t u_size,
+                          const uintmax_t *v,
+                          size_t v_size)
+{
+	constexpr uintmax_t limb_bits = sizeof(uintmax_t) * CHAR_BIT;
+
+	const size_t n = v_size;
+	const size_t m = u_size - v_size;
+
+	// normalise so the top bit of the divisor is set, this keeps the quotient
+	// estimates within 2 of the real value.
+	const int shift = std::countl_zero(v[n - 1U]);
+	auto shl        = [shift](uintmax_t high, uintmax_t low) -> uintmax_t
+	{
+		return shift == 0 ? high
+		                  : (high << shift) | (low >> (limb_bits - shift));
+	};
+
+	std::vector<uintmax_t> scratch(n + u_size + 1U);
+	uintmax_t *vn = scratch.data();
+	uintmax_t *un = vn + n;
+
+	for (size_t i = n; i-- > 1U;) vn[i] = shl(v[i], v[i - 1U]);
+	vn[0U] = v[0U] << shift;
+
+	un[u_size] = shl(0U, u[u_size - 1U]);
+	for (size_t i = u_size; i-- > 1U;) un[i] = shl(u[i], u[i - 1U]);
+	un[0U] = u[0U] << shift;
+
+	const uintmax_t v_top  = vn[n - 1U];
+	const uintmax_t v_next = vn[n - 2U];
+
+	for (size_t j = m + 1U; j-- > 0U;)
+	{
+		uintmax_t q_hat;
+		uintmax_t r_hat;
+		bool r_hat_overflow = false;
+		if (un[j + n] >= v_top)
+		{
+			// the top limbs are equal, the estimate saturates.
+			q_hat          = UINTMAX_MAX;
+			r_hat          = un[j + n - 1U] + v_top;
+			r_hat_overflow = r_hat < v_top;
+		}
+		else
+		{
+			const lak::uintmax_div_rem_t est =
+			  lak::div_uintmax2({.high = un[j + n], .low = un[j + n - 1U]}, v_top);
+			q_hat = est.quotient;
+			r_hat = est.remainder;
+		}
+
+		while (!r_hat_overflow)
+		{
+			const lak::uintmax2_t p = lak::mul_uintmax2(q_hat, v_next);
+			if (p.high < r_hat || (p.high == r_hat && p.low <= un[j + n - 2U]))
+				break;
+			--q_hat;
+			r_hat += v_top;
+			r_hat_overflow = r_hat < v_top;
+		}
+
+		if (mul_sub_limbs(un + j, vn, n, q_hat) != 0U)
+		{
+			// q_hat was one too big, add a divisor back (the carry out cancels the
+			// borrow).
+			--q_hat;
+			un[j + n] += add_limbs(un + j, un + j, n, vn, n);
+		}
+
+		quotient[j] = q_hat;
+	}
+
+	// undo the normalisation.
+	for (size_t i = 0U; i + 1U < n; ++i)
+		remainder[i] = shift == 0 ? un[i]
+		                          : (un[i] >> shift) |
+		                              (un[i + 1U] << (limb_bits - shift));
+	remainder[n - 1U] = un[n - 1U] >> shift;
+}
+
 lak::bigint &lak::bigint::negate()
 {
 	_negative = !_negative;
@@ -39,7 +322,7 @@ size_t lak::bigint::min_size() const
 
 lak::span<const uintmax_t> lak::bigint::min_span() const
 {
-	return lak::span(_data).first(min_size());
+	return _data.span().first(min_size());
 }
 
 void lak::bigint::add(uintmax_t value)
@@ -89,16 +372,18 @@ lak::bigint::div_rem_result lak::bigint::div_rem_impl(uintmax_t value,
 
 	lak::bigint::div_rem_result result;
 
-	for (uintmax_t i = min_bit_count(); i-- > 0U;)
+	const lak::span<const uintmax_t> dividend = min_span();
+	result.first._data.resize(dividend.size());
+
+	uintmax_t remainder = 0U;
+	for (size_t i = dividend.size(); i-- > 0U;)
 	{
-		result.second <<= 1U;
-		result.second.set_bit(0U, bit(i));
-		if (result.second >= value)
-		{
-			result.second -= value;
-			result.first.set_bit(i, 1U);
-		}
+		const lak::uintmax_div_rem_t step =
+		  lak::div_uintmax2({.high = remainder, .low = dividend[i]}, value);
+		result.first._data[i] = step.quotient;
+		remainder             = step.remainder;
 	}
+	result.second = remainder;
 
 	result.first.normalise();
 	result.second.normalise();
@@ -141,22 +426,9 @@ void lak::bigint::sub(const lak::bigint &value)
 	const size_t r_max = value.min_size();
 	ASSERT_GREATER_OR_EQUAL(l_max, r_max);
 
-	for (size_t i = 0U; i < r_max; ++i)
-	{
-		uintmax_t carry = 0U;
-		{
-			lak::uintmax2_t result = lak::sub_uintmax2(_data[i], value._data[i]);
-			_data[i]               = result.low;
-			carry                  = result.high;
-		}
-		for (size_t carry_i = i; carry_i < l_max && carry != 0U; ++carry_i)
-		{
-			lak::uintmax2_t result = lak::sub_uintmax2(_data[carry_i], 0U, carry);
-			_data[carry_i]         = result.low;
-			carry                  = result.high;
-		}
-		ASSERT_EQUAL(carry, 0U);
-	}
+	const uintmax_t borrow =
+	  sub_limbs(_data.data(), _data.data(), l_max, value._data.data(), r_max);
+	ASSERT_EQUAL(borrow, 0U);
 
 	normalise();
 }
@@ -166,17 +438,28 @@ lak::bigint::div_rem_result lak::bigint::div_rem_impl(const lak::bigint &value,
 {
 	ASSERT_NOT_EQUAL(value, 0U);
 
+	const lak::span<const uintmax_t> divisor  = value.min_span();
+	const lak::span<const uintmax_t> dividend = min_span();
+
+	if (divisor.size() == 1U) return div_rem_impl(divisor[0U], negate_output);
+
 	lak::bigint::div_rem_result result;
 
-	for (uintmax_t i = bit_count(); i-- > 0U;)
+	if (dividend.size() < divisor.size())
 	{
-		result.second <<= 1U;
-		result.second.set_bit(0U, bit(i));
-		if (result.second >= value)
-		{
-			result.second -= value;
-			result.first.set_bit(i, 1U);
-		}
+		result.second = *this;
+		result.second._negative = false;
+	}
+	else
+	{
+		result.first._data.resize(dividend.size() - divisor.size() + 1U);
+		result.second._data.resize(divisor.size());
+		div_rem_limbs(result.first._data.data(),
+		              result.second._data.data(),
+		              dividend.data(),
+		              dividend.size(),
+		              divisor.data(),
+		              divisor.size());
 	}
 
 	result.first.normalise();
@@ -191,6 +474,152 @@ lak::bigint::div_rem_result lak::bigint::div_rem_impl(const lak::bigint &value,
 	return result;
 }
 
+void lak::bigint::append_pow2_digits(std::string &str,
+                                     unsigned bits_per_digit) const
+{
+	constexpr uintmax_t limb_bits = sizeof(uintmax_t) * CHAR_BIT;
+	constexpr char digits[]       = "0123456789abcdef";
+
+	const lak::span<const uintmax_t> limbs = min_span();
+	const uintmax_t bit_count              = min_bit_count();
+	const uintmax_t mask = (uintmax_t(1U) << bits_per_digit) - 1U;
+
+	if (bit_count == 0U)
+	{
+		str += '0';
+		return;
+	}
+
+	for (uintmax_t digit = (bit_count + bits_per_digit - 1U) / bits_per_digit;
+	     digit-- > 0U;)
+	{
+		const uintmax_t index  = digit * bits_per_digit;
+		const size_t limb      = index / limb_bits;
+		const uintmax_t offset = index % limb_bits;
+		uintmax_t value        = limbs[limb] >> offset;
+		// only octal digits can straddle two limbs.
+		if (offset + bits_per_digit > limb_bits && limb + 1U < limbs.size())
+			value |= limbs[limb + 1U] << (limb_bits - offset);
+		str += digits[value & mask];
+	}
+}
+
+void lak::bigint::append_dec_digits(std::string &str,
+                                    size_t min_digits,
+                                    lak::span<const lak::bigint> powers) const
+{
+	if (powers.size() > 0U && min_size() > dec_split_threshold)
+	{
+		const lak::bigint &split = powers[powers.size() - 1U];
+		const lak::span<const lak::bigint> lower_powers =
+		  powers.first(powers.size() - 1U);
+
+		if (*this < split)
+		{
+			append_dec_digits(str, min_digits, lower_powers);
+		}
+		else
+		{
+			// this = high * split + low, low is exactly low_digits long.
+			const size_t low_digits = dec_chunk_digits << lower_powers.size();
+			const div_rem_result parts = div_rem(split);
+			parts.first.append_dec_digits(
+			  str,
+			  min_digits > low_digits ? min_digits - low_digits : 0U,
+			  lower_powers);
+			parts.second.append_dec_digits(str, low_digits, lower_powers);
+		}
+		return;
+	}
+
+	// peel off 19 digits at a time, least significant chunk first.
+	lak::small_vector<uintmax_t, 4U> value = _data;
+	value.resize(min_size());
+	std::vector<uintmax_t> chunks;
+	chunks.reserve((value.size() * 20U) / dec_chunk_digits + 1U);
+	while (!value.empty())
+	{
+		uintmax_t remainder = 0U;
+		for (size_t i = value.size(); i-- > 0U;)
+		{
+			const lak::uintmax_div_rem_t step =
+			  lak::div_uintmax2({.high = remainder, .low = value[i]}, dec_chunk);
+			value[i]  = step.quotient;
+			remainder = step.remainder;
+		}
+		chunks.push_back(remainder);
+		while (!value.empty() && value.back() == 0U) value.pop_back();
+	}
+
+	char buffer[dec_chunk_digits];
+	auto chunk_digits = [&](uintmax_t chunk) -> size_t
+	{
+		size_t count = 0U;
+		for (; chunk != 0U; chunk /= 10U)
+			buffer[dec_chunk_digits - ++count] = char('0' + (chunk % 10U));
+		return count;
+	};
+
+	const size_t top_digits =
+	  chunks.empty() ? 0U : chunk_digits(chunks.back());
+	const size_t digit_count =
+	  chunks.empty() ? 0U
+	                 : top_digits + ((chunks.size() - 1U) * dec_chunk_digits);
+
+	// zero is written as a single 0 unless padding was asked for.
+	if (const size_t padded = std::max<size_t>(min_digits, 1U);
+	    digit_count < padded)
+		str.append(padded - digit_count, '0');
+
+	if (chunks.empty()) return;
+
+	str.append(buffer + (dec_chunk_digits - top_digits),
+	           buffer + dec_chunk_digits);
+	for (size_t i = chunks.size() - 1U; i-- > 0U;)
+	{
+		const size_t count = chunk_digits(chunks[i]);
+		std::fill(buffer, buffer + dec_chunk_digits - count, '0');
+		str.append(buffer, buffer + dec_chunk_digits);
+	}
+}
+
+std::string lak::bigint::to_string(lak::numeric_base base) const
+{
+	std::string result;
+
+	if (is_negative() && !is_zero()) result += '-';
+
+	switch (base)
+	{
+		case lak::numeric_base::bin: append_pow2_digits(result, 1U); break;
+		case lak::numeric_base::oct: append_pow2_digits(result, 3U); break;
+		case lak::numeric_base::hex: append_pow2_digits(result, 4U); break;
+		case lak::numeric_base::dec:
+		{
+			lak::bigint magnitude = *this;
+			magnitude._negative   = false;
+
+			// 10^19, 10^38, 10^76, ... until the last power exceeds the value.
+			std::vector<lak::bigint> powers;
+			if (magnitude.min_size() > dec_split_threshold)
+			{
+				powers.push_back(lak::bigint(dec_chunk));
+				while (powers.back() <= magnitude)
+					powers.push_back(powers.back() * powers.back());
+			}
+
+			magnitude.append_dec_digits(
+			  result,
+			  0U,
+			  lak::span<const lak::bigint>(powers.data(), powers.size()));
+		}
+		break;
+		default: ASSERT_UNREACHABLE();
+	}
+
+	return result;
+}
+
 lak::bigint::bigint(uintmax_t value)
 {
 	if (value != 0U)
@@ -210,6 +639,7 @@ lak::bigint::bigint(intmax_t value)
 
 lak::bigint &lak::bigint::operator=(uintmax_t value)
 {
+	_negative = false;
 	if (value != 0U)
 	{
 		_data.resize(1U);
@@ -238,9 +668,10 @@ lak::result<uintmax_t> lak::bigint::to_uintmax() const
 lak::result<intmax_t> lak::bigint::to_intmax() const
 {
 	if (min_size() > 1U) return lak::err_t{};
-	if (_data[0U] > static_cast<uintmax_t>(INTMAX_MAX)) return lak::err_t{};
+	const uintmax_t value = min_size() == 0U ? 0U : _data[0U];
+	if (value > static_cast<uintmax_t>(INTMAX_MAX)) return lak::err_t{};
 
-	intmax_t result = static_cast<intmax_t>(_data.empty() ? 0U : _data[0U]);
+	intmax_t result = static_cast<intmax_t>(value);
 	return lak::ok_t<intmax_t>{is_negative() ? -result : result};
 }
 
@@ -392,36 +823,26 @@ lak::bigint &lak::bigint::operator%=(uintmax_t rhs)
 
 lak::bigint &lak::bigint::operator<<=(uintmax_t rhs)
 {
-	if (rhs == 0) return *this;
+	constexpr uintmax_t limb_bits = sizeof(uintmax_t) * CHAR_BIT;
 
-	const size_t whole_shift  = rhs / (sizeof(uintmax_t) * CHAR_BIT);
-	const uintmax_t bit_shift = rhs % (sizeof(uintmax_t) * CHAR_BIT);
-	const size_t old_size     = _data.size();
+	if (rhs == 0 || is_zero()) return *this;
 
-	reserve(old_size + whole_shift + 1U);
+	const size_t whole_shift  = rhs / limb_bits;
+	const uintmax_t bit_shift = rhs % limb_bits;
+	const size_t old_size     = min_size();
 
-	if (bit_shift == 0)
+	_data.resize(old_size + whole_shift + 1U, 0U);
+
+	// top down, so each limb is read before anything is written over it.
+	for (size_t i = old_size; i-- > 0U;)
 	{
-		// simple memmove
-		lak::memmove(reinterpret_cast<byte_t *>(_data.data() + whole_shift),
-		             reinterpret_cast<const byte_t *>(_data.data()),
-		             old_size);
-	}
-	else
-	{
-		const uintmax_t high_mask = UINTMAX_MAX << bit_shift;
-		const uintmax_t low_mask  = ~high_mask;
-		for (size_t i = old_size; i-- > 0;)
-		{
-			uintmax_t value        = _data[i];
-			_data[i + whole_shift] = value << bit_shift;
-			_data[i + whole_shift + 1U] =
-			  (_data[i + whole_shift + 1U] & high_mask) |
-			  (value >> ((sizeof(uintmax_t) * CHAR_BIT) - bit_shift));
-		}
+		const uintmax_t value = _data[i];
+		if (bit_shift != 0U)
+			_data[i + whole_shift + 1U] |= value >> (limb_bits - bit_shift);
+		_data[i + whole_shift] = value << bit_shift;
 	}
 
-	lak::fill(lak::span(_data).first(whole_shift), uintmax_t(0));
+	lak::fill(_data.span().first(whole_shift), uintmax_t(0));
 
 	normalise();
 
@@ -430,29 +851,28 @@ lak::bigint &lak::bigint::operator<<=(uintmax_t rhs)
 
 lak::bigint &lak::bigint::operator>>=(uintmax_t rhs)
 {
+	constexpr uintmax_t limb_bits = sizeof(uintmax_t) * CHAR_BIT;
+
 	if (rhs == 0) return *this;
 
-	const size_t whole_shift  = rhs / (sizeof(uintmax_t) * CHAR_BIT);
-	const uintmax_t bit_shift = rhs % (sizeof(uintmax_t) * CHAR_BIT);
-	const size_t new_size     = _data.size() - whole_shift;
+	const size_t whole_shift  = rhs / limb_bits;
+	const uintmax_t bit_shift = rhs % limb_bits;
+	const size_t old_size     = min_size();
 
-	if (bit_shift == 0)
+	if (whole_shift >= old_size)
 	{
-		// simple memmove
-		lak::memmove(reinterpret_cast<byte_t *>(_data.data()),
-		             reinterpret_cast<const byte_t *>(_data.data() + whole_shift),
-		             new_size);
+		_data.clear();
+		return *this;
 	}
-	else
+
+	// bottom up, each limb only reads from itself and the limbs above it.
+	const size_t new_size = old_size - whole_shift;
+	for (size_t i = 0U; i < new_size; ++i)
 	{
-		const uintmax_t low_mask  = UINTMAX_MAX >> bit_shift;
-		const uintmax_t high_mask = ~low_mask;
-		for (size_t i = 0; i < new_size; ++i)
-		{
-			uintmax_t value = _data[i + whole_shift];
-			_data[i]        = (_data[i] & high_mask) | (value >> bit_shift);
-			_data[i + 1U] = (value << ((sizeof(uintmax_t) * CHAR_BIT) - bit_shift));
-		}
+		uintmax_t value = _data[i + whole_shift] >> bit_shift;
+		if (bit_shift != 0U && i + 1U < new_size)
+			value |= _data[i + whole_shift + 1U] << (limb_bits - bit_shift);
+		_data[i] = value;
 	}
 
 	_data.resize(new_size);
@@ -706,7 +1126,7 @@ lak::bigint &lak::bigint::operator-=(const lak::bigint &rhs)
 		if (is_negative() ? *this <= rhs : *this >= rhs)
 			sub(rhs);
 		else
-			*this = rhs - *this;
+			*this = -(rhs - *this);
 	}
 	else
 		add(rhs);
@@ -716,31 +1136,27 @@ lak::bigint &lak::bigint::operator-=(const lak::bigint &rhs)
 
 lak::bigint &lak::bigint::operator*=(const lak::bigint &rhs)
 {
-	normalise();
-
+	const lak::span<const uintmax_t> lhs_span = min_span();
 	const lak::span<const uintmax_t> rhs_span = rhs.min_span();
-	const size_t rhs_size                     = rhs_span.size();
 	const bool negative_result = is_negative() != rhs.is_negative();
 
-	_negative = false;
-
-	if (rhs_size == 0U || is_zero() || rhs.is_zero())
+	if (lhs_span.size() == 0U || rhs_span.size() == 0U)
 	{
 		_data.clear();
+		_negative = false;
 		return *this;
 	}
 
-	_data.reserve(_data.size() + rhs_size);
-
 	lak::bigint result;
+	result._data.resize(lhs_span.size() + rhs_span.size());
 
-	for (const uintmax_t &v : rhs_span)
-	{
-		result += *this * v;
-		_data.insert(_data.begin(), 0U);
-	}
+	mul_limbs(result._data.data(),
+	          lhs_span.data(),
+	          lhs_span.size(),
+	          rhs_span.data(),
+	          rhs_span.size());
 
-	lak::swap(*this, result);
+	lak::swap(_data, result._data);
 
 	_negative = negative_result;
 
@@ -879,10 +1295,11 @@ lak::strong_ordering lak::bigint::operator<=>(const lak::bigint &rhs) const
 			auto r_span = rhs.min_span();
 			if (l_span.size() > r_span.size()) return lak::strong_ordering::less;
 			if (l_span.size() < r_span.size()) return lak::strong_ordering::greater;
+			// the larger magnitude is the lesser value.
 			for (size_t i = l_span.size(); i-- > 0;)
 			{
-				if (l_span[i] < r_span[i]) return lak::strong_ordering::less;
-				if (l_span[i] > r_span[i]) return lak::strong_ordering::greater;
+				if (l_span[i] > r_span[i]) return lak::strong_ordering::less;
+				if (l_span[i] < r_span[i]) return lak::strong_ordering::greater;
 			}
 			return lak::strong_ordering::equal;
 		}
@@ -926,3 +1343,311 @@ lak::bigint lak::bigint::operator-() &&
 {
 	return negate();
 }
+
+/* --- tests --- */
+
+// operand for the generated test cases: splitmix64 limbs, so the expected
+// results could be computed outside of this code (they came from python).
+// pattern 0 is random, 1 has every limb but the lowest all ones (long carry
+// and borrow chains) and 2 has a top limb of 1 (maximum normalisation).
+struct test_operand
+{
+	uint64_t seed;
+	size_t limbs;
+	unsigned pattern;
+
+	lak::bigint make() const
+	{
+		std::vector<uintmax_t> data(limbs);
+		uint64_t state = seed * 0x9E3779B97F4A7C15U;
+		for (auto &limb : data)
+		{
+			state += 0x9E3779B97F4A7C15U;
+			uint64_t z = state;
+			z          = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9U;
+			z          = (z ^ (z >> 27U)) * 0x94D049BB133111EBU;
+			limb       = z ^ (z >> 31U);
+		}
+		if (pattern == 1U) std::fill(data.begin() + 1, data.end(), UINTMAX_MAX);
+		if (pattern == 2U)
+			data.back() = 1U;
+		else
+			data.back() |= 1U;
+
+		lak::bigint result;
+		for (size_t i = data.size(); i-- > 0U;)
+		{
+			result <<= uintmax_t(64U);
+			result += data[i];
+		}
+		return result;
+	}
+};
+
+// the expected results are stored as FNV-1a hashes of their strings.
+static uint64_t test_hash(const std::string &str)
+{
+	uint64_t hash = 0xCBF29CE484222325U;
+	for (const char c : str)
+	{
+		hash ^= uint8_t(c);
+		hash *= 0x100000001B3U;
+	}
+	return hash;
+}
+
+static lak::bigint test_limbs(std::initializer_list<uintmax_t> high_to_low)
+{
+	lak::bigint result;
+	for (const uintmax_t limb : high_to_low)
+	{
+		result <<= uintmax_t(64U);
+		result += limb;
+	}
+	return result;
+}
+
+void bigint_test()
+{
+	SCOPED_CHECKPOINT("Bigint tests");
+
+	const auto hex = [](const lak::bigint &value)
+	{ return value.to_string(lak::numeric_base::hex); };
+
+	/* --- shifts --- */
+
+	{
+		const lak::bigint value = lak::bigint(uintmax_t(3U)) << uintmax_t(100U);
+		ASSERT_EQUAL(hex(value), "30000000000000000000000000");
+		ASSERT_EQUAL(hex(value >> uintmax_t(1U)), "18000000000000000000000000");
+		ASSERT_EQUAL(hex(value >> uintmax_t(64U)), "3000000000");
+		ASSERT_EQUAL(hex(value >> uintmax_t(70U)), "c0000000");
+		ASSERT(lak::bigint(uintmax_t(5U)) >> uintmax_t(200U) == 0U);
+	}
+
+	/* --- two limb by one limb division --- */
+
+	{
+		const auto one_bit = lak::div_uintmax2({.high = 1U, .low = 0U}, 2U);
+		ASSERT_EQUAL(one_bit.quotient, uintmax_t(1U) << 63U);
+		ASSERT_EQUAL(one_bit.remainder, 0U);
+
+		// 2^127 - 1 = (2^64 - 1) * 2^63 + 2^63 - 1
+		const auto full = lak::div_uintmax2(
+		  {.high = UINTMAX_MAX >> 1U, .low = UINTMAX_MAX}, uintmax_t(1U) << 63U);
+		ASSERT_EQUAL(full.quotient, UINTMAX_MAX);
+		ASSERT_EQUAL(full.remainder, UINTMAX_MAX >> 1U);
+
+		// 5 * 2^64 + 124 = 13176245766935394029 * 7 + 1
+		const auto small = lak::div_uintmax2({.high = 5U, .low = 124U}, 7U);
+		ASSERT_EQUAL(small.quotient, 13176245766935394029U);
+		ASSERT_EQUAL(small.remainder, 1U);
+	}
+
+	/* --- division --- */
+
+	{
+		// single limb divisor fast path.
+		const lak::bigint value = test_limbs({1U, 0U, 5U});
+		const auto [quotient, remainder] = value.div_rem(lak::bigint(7U));
+		ASSERT_EQUAL(hex(quotient), "24924924924924924924924924924925");
+		ASSERT_EQUAL(hex(remainder), "2");
+	}
+
+	{
+		// 3 * 2^128 / (2^128 + 1), the first estimate of the only quotient
+		// limb survives the two limb correction but is still one too big, so
+		// algorithm D has to add the divisor back.
+		const auto [quotient, remainder] =
+		  test_limbs({3U, 0U, 0U}).div_rem(test_limbs({1U, 0U, 1U}));
+		ASSERT_EQUAL(hex(quotient), "2");
+		ASSERT_EQUAL(hex(remainder), "fffffffffffffffffffffffffffffffe");
+	}
+
+	{
+		const auto [quotient, remainder] =
+		  test_limbs({uintmax_t(1U) << 63U, 0U, 3U})
+		    .div_rem(test_limbs({1U, 0U, 1U}));
+		ASSERT_EQUAL(hex(quotient), "7fffffffffffffff");
+		ASSERT_EQUAL(hex(remainder), "ffffffffffffffff8000000000000004");
+	}
+
+	/* --- subtraction signs --- */
+
+	{
+		lak::bigint value = 5;
+		value -= lak::bigint(9);
+		ASSERT_EQUAL(value.to_string(), "-4");
+
+		value = -5;
+		value -= lak::bigint(-9);
+		ASSERT_EQUAL(value.to_string(), "4");
+
+		value = -9;
+		value -= lak::bigint(-5);
+		ASSERT_EQUAL(value.to_string(), "-4");
+
+		value = test_limbs({1U, 0U});
+		value -= test_limbs({2U, 0U});
+		ASSERT_EQUAL(hex(value), "-10000000000000000");
+	}
+
+	/* --- generated --- */
+
+	struct mul_case
+	{
+		test_operand a;
+		test_operand b;
+		uint64_t product;
+	};
+	struct div_case
+	{
+		test_operand u;
+		test_operand v;
+		uint64_t quotient;
+		uint64_t remainder;
+	};
+	struct dec_case
+	{
+		test_operand value;
+		uint64_t positive;
+		uint64_t negative;
+	};
+
+	// schoolbook, karatsuba either side of karatsuba_threshold and the
+	// unbalanced slicing.
+	static constexpr mul_case mul_cases[] = {
+	  {{1U, 23U, 0U}, {2U, 23U, 0U}, 0x1AF244DAF5C62C1FU},
+	  {{3U, 24U, 0U}, {4U, 24U, 0U}, 0x8A4F36F1FED99835U},
+	  {{5U, 25U, 0U}, {6U, 25U, 0U}, 0xA4ACA792A6E6D07DU},
+	  {{7U, 24U, 0U}, {8U, 23U, 0U}, 0xD74878F71ABC271EU},
+	  {{9U, 47U, 0U}, {10U, 24U, 0U}, 0x6FF02D667EE47B32U},
+	  {{11U, 48U, 0U}, {12U, 24U, 0U}, 0x34608E921494DE02U},
+	  {{13U, 49U, 0U}, {14U, 24U, 0U}, 0x57D404AAF47BFD0FU},
+	  {{15U, 61U, 0U}, {16U, 30U, 0U}, 0xCA556DF6E5EF5590U},
+	  {{17U, 48U, 0U}, {18U, 48U, 0U}, 0x61F4F9BEA389F093U},
+	  {{19U, 97U, 0U}, {20U, 50U, 0U}, 0xA72591FEC7344CAEU},
+	  {{21U, 100U, 0U}, {22U, 10U, 0U}, 0x19E3D907EBA7643DU},
+	  {{23U, 64U, 0U}, {24U, 64U, 0U}, 0xE2C226841E6009E1U},
+	  {{25U, 37U, 0U}, {26U, 100U, 0U}, 0x82602D86D69C8B8FU},
+	  {{27U, 200U, 0U}, {28U, 199U, 0U}, 0x6A1B32299941FE7DU},
+	  {{29U, 150U, 0U}, {30U, 40U, 0U}, 0x836D978AEADE9A4AU},
+	  {{31U, 25U, 1U}, {32U, 25U, 1U}, 0x3B63694FF5D30ACAU},
+	  {{33U, 48U, 1U}, {34U, 48U, 1U}, 0x32528E1A754F9D84U},
+	  {{35U, 100U, 1U}, {36U, 24U, 1U}, 0x4BABE68D33189229U},
+	  {{37U, 73U, 2U}, {38U, 36U, 1U}, 0x34B83D6CDA700A54U},
+	};
+
+	// the one limb fast path, small and large normalisation shifts and
+	// dividends shorter than the divisor.
+	static constexpr div_case div_cases[] = {
+	  {{100U, 2U, 0U},
+	   {101U, 1U, 0U},
+	   0x2BF5C65B896F8EFCU,
+	   0xC33C54E05CAB5C41U},
+	  {{102U, 5U, 0U},
+	   {103U, 1U, 0U},
+	   0x6F0B29D2053B05C3U,
+	   0x6A24D77372C45415U},
+	  {{104U, 5U, 1U},
+	   {105U, 1U, 0U},
+	   0xF9E0D4F0AC4CC166U,
+	   0xD14D12348FF15016U},
+	  {{106U, 3U, 0U},
+	   {107U, 2U, 0U},
+	   0x2BF5C65B896F8EFCU,
+	   0x59109242856C49F4U},
+	  {{108U, 10U, 0U},
+	   {109U, 3U, 0U},
+	   0xF4F1FA6955CA4BD6U,
+	   0xE3F9C72EA0EB09B6U},
+	  {{110U, 40U, 0U},
+	   {111U, 7U, 0U},
+	   0x0150C1A22A907F19U,
+	   0xC22FFA3B01F26E30U},
+	  {{112U, 60U, 0U},
+	   {113U, 30U, 0U},
+	   0xD885D115821BC5FEU,
+	   0x27FAD8271650CF80U},
+	  {{114U, 100U, 0U},
+	   {115U, 50U, 0U},
+	   0xD69141E0D5D81201U,
+	   0x53C078F31AC8A2F7U},
+	  {{116U, 30U, 0U},
+	   {117U, 29U, 0U},
+	   0x2BF5C65B896F8EFCU,
+	   0x702F24D9ABC253D6U},
+	  {{118U, 8U, 0U},
+	   {119U, 8U, 0U},
+	   0xAF63AC4C86019AFCU,
+	   0x91411C94BA72D051U},
+	  {{120U, 5U, 0U},
+	   {121U, 6U, 0U},
+	   0xAF63AD4C86019CAFU,
+	   0x16A8344C48171DB8U},
+	  {{122U, 50U, 0U},
+	   {123U, 3U, 2U},
+	   0xE2F1EFE4515AB707U,
+	   0xB882CFE6D17E5149U},
+	  {{124U, 33U, 1U},
+	   {125U, 33U, 1U},
+	   0xAF63AD4C86019CAFU,
+	   0xB57C366A8CDBA3BCU},
+	  {{126U, 40U, 1U},
+	   {127U, 20U, 0U},
+	   0xC6C29B24047F543BU,
+	   0xC553F2B3986F4F6CU},
+	  {{128U, 64U, 0U},
+	   {129U, 33U, 1U},
+	   0xEBCAC89C949D276EU,
+	   0xA4681AAF993DEA5AU},
+	  {{130U, 80U, 2U},
+	   {131U, 40U, 2U},
+	   0xCDD0212C656EE32EU,
+	   0xABDF3D5A37238F28U},
+	};
+
+	// either side of dec_split_threshold.
+	static constexpr dec_case dec_cases[] = {
+	  {{200U, 1U, 0U}, 0x0AEFF580CCC412A3U, 0xE2066BCA7DBC3FECU},
+	  {{201U, 2U, 0U}, 0x48876F5AAD3EE0BDU, 0x3C3C4D44939891AEU},
+	  {{202U, 31U, 0U}, 0x2B26CA4DF5C1DB55U, 0x07979648D5A20D0AU},
+	  {{203U, 32U, 0U}, 0xE271766B2955A676U, 0xB8EA5E0F91ACAC75U},
+	  {{204U, 33U, 0U}, 0xA6BCFE521174D38CU, 0xC02A82DF96226085U},
+	  {{205U, 34U, 1U}, 0x1F8DD014A1728EC2U, 0x98A723A4AA55D7BFU},
+	  {{206U, 64U, 0U}, 0xCD1472862FF62916U, 0xBC987EB05DAA0B4DU},
+	  {{207U, 65U, 2U}, 0xBA0A37A84240C1D7U, 0xCECA134DBE3DAB2AU},
+	  {{208U, 100U, 0U}, 0x0A7EEDF0F298ECE1U, 0xF278F9C34BB10924U},
+	  {{209U, 257U, 0U}, 0x6075A73933D36CF6U, 0xF77AE2CA845EF1E3U},
+	};
+
+	for (const auto &c : mul_cases)
+	{
+		const lak::bigint a       = c.a.make();
+		const lak::bigint b       = c.b.make();
+		const lak::bigint product = a * b;
+		ASSERT_EQUAL(test_hash(hex(product)), c.product);
+		ASSERT(product / b == a);
+		ASSERT(product % a == 0U);
+	}
+
+	for (const auto &c : div_cases)
+	{
+		const lak::bigint u              = c.u.make();
+		const lak::bigint v              = c.v.make();
+		const auto [quotient, remainder] = u.div_rem(v);
+		ASSERT_EQUAL(test_hash(hex(quotient)), c.quotient);
+		ASSERT_EQUAL(test_hash(hex(remainder)), c.remainder);
+		ASSERT(remainder < v);
+		ASSERT(quotient * v + remainder == u);
+	}
+
+	for (const auto &c : dec_cases)
+	{
+		const lak::bigint value = c.value.make();
+		ASSERT_EQUAL(test_hash(value.to_string()), c.positive);
+		ASSERT_EQUAL(test_hash((-value).to_string()), c.negative);
+	}
+
+	DEBUG(LAK_GREEN "Bigint tests complete" LAK_SGR_RESET);
+}
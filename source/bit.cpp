@@ -1 +1,1218 @@
 #include "bit.hpp"
+
+#include "fasm2bit.hpp"
+
+#include "lak/string_literals.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <numeric>
+
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#elif defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
+/* --- frame_address --- */
+
+uint32_t frame_address::encode() const
+{
+	return (uint32_t(block) << 23U) | (uint32_t(bottom) << 22U) |
+	       (uint32_t(row & 0x1FU) << 17U) | (uint32_t(column & 0x3FFU) << 7U) |
+	       uint32_t(minor & 0x7FU);
+}
+
+frame_address frame_address::decode(uint32_t address)
+{
+	return {
+	  .block  = block_type((address >> 23U) & 0x7U),
+	  .bottom = ((address >> 22U) & 0x1U) != 0U,
+	  .row    = uint8_t((address >> 17U) & 0x1FU),
+	  .column = uint16_t((address >> 7U) & 0x3FFU),
+	  .minor  = uint8_t(address & 0x7FU),
+	};
+}
+
+lak::result<frame_address::block_type> frame_address::parse_block_type(
+  lak::astring_view name)
+{
+	if (name == "CLB_IO_CLK"_view)
+		return lak::ok_t{frame_address::block_type::clb_io_clk};
+	if (name == "BLOCK_RAM"_view)
+		return lak::ok_t{frame_address::block_type::block_ram};
+	if (name == "CFG_CLB"_view)
+		return lak::ok_t{frame_address::block_type::cfg_clb};
+	user_error("Unknown configuration bus '", name, "'");
+	return lak::err_t{};
+}
+
+/* --- part.json --- */
+
+static lak::result<const json_parser::object *> get_object(
+  const json_parser::object &obj, lak::astring_view key)
+{
+	if (const json_parser::value_type *value = obj.find(key); value)
+		if (const json_parser::object *result = value->obj(); result)
+			return lak::ok_t{result};
+	user_error("Expected object '", key, "' in part file");
+	return lak::err_t{};
+}
+
+static lak::result<uint32_t> parse_uint(lak::astring_view str)
+{
+	uint32_t result = 0U;
+	if (const auto [ptr, ec] = std::from_chars(str.begin(), str.end(), result);
+	    ec != std::errc{} || ptr != str.end())
+	{
+		user_error("Expected integer in part file, got '", str, "'");
+		return lak::err_t{};
+	}
+	return lak::ok_t{result};
+}
+
+static lak::result<uint32_t> get_uint(const json_parser::object &obj,
+                                      lak::astring_view key)
+{
+	if (const json_parser::value_type *value = obj.find(key); value)
+		if (const lak::astring_view *result = value->lit(); result)
+			return parse_uint(*result);
+	user_error("Expected integer '", key, "' in part file");
+	return lak::err_t{};
+}
+
+lak::result<frame_memory> frame_memory::from_part(
+  const json_parser::value_type &part_json)
+{
+	frame_memory result;
+
+	const json_parser::object *part = part_json.obj();
+	if (!part)
+	{
+		user_error("Expected object at the root of the part file");
+		return lak::err_t{};
+	}
+
+	RES_TRY_ASSIGN(result.idcode =, get_uint(*part, "idcode"_view));
+
+	struct column
+	{
+		frame_address address;
+		uint32_t frame_count;
+	};
+	std::vector<column> columns;
+
+	RES_TRY_ASSIGN(const json_parser::object *regions =,
+	               get_object(*part, "global_clock_regions"_view));
+
+	for (const auto &half : regions->key_values)
+	{
+		const bool bottom = half.key.value == "bottom"_view;
+		if (!bottom && half.key.value != "top"_view) continue;
+
+		const json_parser::object *half_obj = half.value.obj();
+		if (!half_obj) continue;
+
+		RES_TRY_ASSIGN(const json_parser::object *rows =,
+		               get_object(*half_obj, "rows"_view));
+
+		for (const auto &row : rows->key_values)
+		{
+			RES_TRY_ASSIGN(const uint32_t row_index =, parse_uint(row.key.value));
+
+			const json_parser::object *row_obj = row.value.obj();
+			if (!row_obj) continue;
+
+			RES_TRY_ASSIGN(const json_parser::object *buses =,
+			               get_object(*row_obj, "configuration_buses"_view));
+
+			for (const auto &bus : buses->key_values)
+			{
+				RES_TRY_ASSIGN(const frame_address::block_type block =,
+				               frame_address::parse_block_type(bus.key.value));
+
+				const json_parser::object *bus_obj = bus.value.obj();
+				if (!bus_obj) continue;
+
+				RES_TRY_ASSIGN(const json_parser::object *bus_columns =,
+				               get_object(*bus_obj, "configuration_columns"_view));
+
+				for (const auto &col : bus_columns->key_values)
+				{
+					RES_TRY_ASSIGN(const uint32_t column_index =,
+					               parse_uint(col.key.value));
+
+					const json_parser::object *col_obj = col.value.obj();
+					if (!col_obj) continue;
+
+					RES_TRY_ASSIGN(const uint32_t frame_count =,
+					               get_uint(*col_obj, "frame_count"_view));
+
+					columns.push_back({
+					  .address =
+					    {
+					      .block  = block,
+					      .bottom = bottom,
+					      .row    = uint8_t(row_index),
+					      .column = uint16_t(column_index),
+					    },
+					  .frame_count = frame_count,
+					});
+				}
+			}
+		}
+	}
+
+	// frame address register auto-increment order.
+	std::sort(columns.begin(),
+	          columns.end(),
+	          [](const column &a, const column &b)
+	          {
+		          return a.address.encode() < b.address.encode();
+	          });
+
+	size_t frame_count = 0U;
+	for (const auto &col : columns) frame_count += col.frame_count;
+
+	result.addresses.reserve(frame_count);
+	result.address_index.reserve(frame_count);
+	for (const auto &col : columns)
+	{
+		for (uint32_t minor = 0U; minor < col.frame_count; ++minor)
+		{
+			frame_address address = col.address;
+			address.minor         = uint8_t(minor);
+			result.address_index.emplace(address.encode(),
+			                             uint32_t(result.addresses.size()));
+			result.addresses.push_back(address.encode());
+		}
+	}
+
+	result.frame_pages.assign(frame_count, default_page);
+	result.pages.assign(words_per_frame, 0U);
+
+	return lak::ok_t{lak::move(result)};
+}
+
+lak::result<size_t> frame_memory::frame_index(uint32_t address) const
+{
+	if (auto it = address_index.find(address); it != address_index.end())
+		return lak::ok_t<size_t>{it->second};
+	return lak::err_t{};
+}
+
+lak::span<uint32_t> frame_memory::write_frame(size_t index)
+{
+	if (frame_pages[index] == default_page)
+	{
+		frame_pages[index] = uint32_t(pages.size() / words_per_frame);
+		pages.resize(pages.size() + words_per_frame);
+		std::copy_n(pages.begin(), words_per_frame, pages.end() - words_per_frame);
+	}
+	return lak::span<uint32_t>(
+	  pages.data() + (size_t(frame_pages[index]) * words_per_frame),
+	  words_per_frame);
+}
+
+/* --- frame_edits --- */
+
+// frame = (frame & ~clear) | set
+static void apply_masks(uint32_t *frame,
+                        const uint32_t *set,
+                        const uint32_t *clear)
+{
+	size_t i = 0U;
+#if defined(__AVX2__)
+	for (; i + 8U <= words_per_frame; i += 8U)
+	{
+		__m256i *dst = reinterpret_cast<__m256i *>(frame + i);
+		const __m256i s =
+		  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(set + i));
+		const __m256i c =
+		  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(clear + i));
+		const __m256i w = _mm256_loadu_si256(dst);
+		_mm256_storeu_si256(dst, _mm256_or_si256(_mm256_andnot_si256(c, w), s));
+	}
+#endif
+#if defined(__SSE2__)
+	for (; i + 4U <= words_per_frame; i += 4U)
+	{
+		__m128i *dst = reinterpret_cast<__m128i *>(frame + i);
+		const __m128i s =
+		  _mm_loadu_si128(reinterpret_cast<const __m128i *>(set + i));
+		const __m128i c =
+		  _mm_loadu_si128(reinterpret_cast<const __m128i *>(clear + i));
+		const __m128i w = _mm_loadu_si128(dst);
+		_mm_storeu_si128(dst, _mm_or_si128(_mm_andnot_si128(c, w), s));
+	}
+#endif
+	for (; i < words_per_frame; ++i) frame[i] = (frame[i] & ~clear[i]) | set[i];
+}
+
+void frame_edits::apply(frame_memory &frames)
+{
+	// counting sort by frame, it's stable so each frame's edits stay in the
+	// order they were made.
+	std::vector<uint32_t> starts(frames.frame_count() + 1U, 0U);
+	for (const edit &e : edits) ++starts[e.frame + 1U];
+	std::partial_sum(starts.begin(), starts.end(), starts.begin());
+
+	std::vector<edit> sorted(edits.size());
+	{
+		std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+		for (const edit &e : edits) sorted[next[e.frame]++] = e;
+	}
+
+	std::array<uint32_t, words_per_frame> set;
+	std::array<uint32_t, words_per_frame> clear;
+	for (size_t frame = 0U; frame < frames.frame_count(); ++frame)
+	{
+		if (starts[frame] == starts[frame + 1U]) continue;
+
+		set.fill(0U);
+		clear.fill(0U);
+		for (uint32_t i = starts[frame]; i < starts[frame + 1U]; ++i)
+		{
+			const edit &e      = sorted[i];
+			const uint32_t bit = uint32_t(1U) << (e.bit & 0x1FU);
+			const size_t word  = e.bit >> 5U;
+			if (e.value)
+			{
+				set[word] |= bit;
+				clear[word] &= ~bit;
+			}
+			else
+			{
+				clear[word] |= bit;
+				set[word] &= ~bit;
+			}
+		}
+
+		apply_masks(frames.write_frame(frame).data(), set.data(), clear.data());
+	}
+
+	edits.clear();
+}
+
+/* --- crc/ecc --- */
+
+// reflected CRC-32C (castagnoli) polynomial.
+static constexpr uint32_t crc_polynomial = 0x82F63B78U;
+
+static constexpr std::array<uint32_t, 256U> crc_table = []
+{
+	std::array<uint32_t, 256U> result = {};
+	for (uint32_t i = 0U; i < 256U; ++i)
+	{
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; ++bit)
+			crc = (crc >> 1U) ^ ((crc & 1U) ? crc_polynomial : 0U);
+		result[i] = crc;
+	}
+	return result;
+}();
+
+uint32_t config_crc(uint32_t crc, uint32_t address, uint32_t data)
+{
+	// the 37 bit message is shifted in lsb first, data then address. the data
+	// bits are a plain reflected CRC-32C step so they can go through the table.
+	for (uint32_t shift = 0U; shift < 32U; shift += 8U)
+		crc = (crc >> 8U) ^ crc_table[(crc ^ (data >> shift)) & 0xFFU];
+	for (uint32_t bit = 0U; bit < 5U; ++bit)
+		crc = (crc >> 1U) ^
+		      (((crc ^ (address >> bit)) & 1U) ? crc_polynomial : 0U);
+	return crc;
+}
+
+uint32_t frame_ecc(lak::span<const uint32_t> frame)
+{
+	// hamming code over the frame with the ECC bits themselves masked out, the
+	// bit positions skip the power of 2 check bit indices.
+	uint32_t ecc = 0U;
+	for (uint32_t index = 0U; index < words_per_frame; ++index)
+	{
+		uint32_t position = index * 32U;
+		if (index > 0x25U)
+			position += 0x1360U;
+		else if (index > 0x6U)
+			position += 0x1340U;
+		else
+			position += 0x1320U;
+
+		uint32_t word = frame[index];
+		if (index == 0x32U) word &= 0xFFFFE000U;
+
+		for (uint32_t bit = 0U; word != 0U; ++bit, word >>= 1U)
+			if (word & 1U) ecc ^= position + bit;
+	}
+
+	// overall parity bit.
+	uint32_t parity = ecc & 0xFFFU;
+	parity ^= parity >> 8U;
+	parity ^= parity >> 4U;
+	parity ^= parity >> 2U;
+	parity ^= parity >> 1U;
+	ecc ^= (parity & 1U) << 12U;
+
+	return ecc & 0x1FFFU;
+}
+
+/* --- packet writer --- */
+
+enum struct config_register : uint32_t
+{
+	crc    = 0x00U,
+	far    = 0x01U,
+	fdri   = 0x02U,
+	cmd    = 0x04U,
+	ctl0   = 0x05U,
+	mask   = 0x06U,
+	cor0   = 0x09U,
+	mfwr   = 0x0AU,
+	idcode = 0x0CU,
+	cor1   = 0x0EU,
+};
+
+enum struct config_command : uint32_t
+{
+	null     = 0x00U,
+	wcfg     = 0x01U,
+	mfw      = 0x02U,
+	dghigh   = 0x03U,
+	start    = 0x05U,
+	rcrc     = 0x07U,
+	grestore = 0x0AU,
+	desync   = 0x0DU,
+};
+
+static constexpr uint32_t sync_word        = 0xAA995566U;
+static constexpr uint32_t nop_packet       = 0x20000000U;
+static constexpr uint32_t type1_write      = 0x30000000U;
+static constexpr uint32_t type2_write      = 0x50000000U;
+static constexpr uint32_t final_address    = 0x03BE0000U;
+static constexpr size_t row_padding_frames = 2U;
+static constexpr size_t mfwr_dummy_words   = 2U;
+
+// upper bound on the packets surrounding the frame data.
+static constexpr size_t packet_overhead_words = 256U;
+
+struct packet_writer
+{
+	std::vector<uint8_t> &out;
+	uint32_t crc = 0U;
+
+	void word(uint32_t value)
+	{
+		out.push_back(uint8_t(value >> 24U));
+		out.push_back(uint8_t(value >> 16U));
+		out.push_back(uint8_t(value >> 8U));
+		out.push_back(uint8_t(value));
+	}
+
+	void nop(size_t count = 1U)
+	{
+		for (size_t i = 0U; i < count; ++i) word(nop_packet);
+	}
+
+	void data(config_register reg, uint32_t value)
+	{
+		word(value);
+		crc = config_crc(crc, uint32_t(reg), value);
+	}
+
+	void write(config_register reg, uint32_t value)
+	{
+		word(type1_write | (uint32_t(reg) << 13U) | 1U);
+		data(reg, value);
+	}
+
+	void command(config_command cmd)
+	{
+		write(config_register::cmd, uint32_t(cmd));
+		if (cmd == config_command::rcrc) crc = 0U;
+	}
+
+	void write_crc()
+	{
+		word(type1_write | (uint32_t(config_register::crc) << 13U) | 1U);
+		word(crc);
+		crc = 0U;
+	}
+
+	// type 1 header with no data followed by a type 2 header for long writes.
+	void begin_long_write(config_register reg, size_t count)
+	{
+		word(type1_write | (uint32_t(reg) << 13U));
+		word(type2_write | uint32_t(count));
+	}
+
+	void frame(lak::span<const uint32_t> frame, uint32_t ecc)
+	{
+		for (size_t i = 0U; i < words_per_frame; ++i)
+			data(config_register::fdri,
+			     i == 0x32U ? (frame[i] & 0xFFFFE000U) | ecc : frame[i]);
+	}
+
+	void padding_frames(size_t count)
+	{
+		for (size_t i = 0U; i < count * words_per_frame; ++i)
+			data(config_register::fdri, 0U);
+	}
+
+	// copy the frame buffer loaded after a MFW command to address.
+	void multi_frame_write(uint32_t address)
+	{
+		write(config_register::far, address);
+		word(type1_write | (uint32_t(config_register::mfwr) << 13U) |
+		     uint32_t(mfwr_dummy_words));
+		for (size_t i = 0U; i < mfwr_dummy_words; ++i)
+			data(config_register::mfwr, 0U);
+	}
+
+	// bus width detection, sync and the start of a configuration write.
+	void begin(uint32_t idcode)
+	{
+		for (size_t i = 0U; i < 8U; ++i) word(0xFFFFFFFFU);
+		word(0x000000BBU);
+		word(0x11220044U);
+		word(0xFFFFFFFFU);
+		word(0xFFFFFFFFU);
+		word(sync_word);
+		nop();
+
+		command(config_command::rcrc);
+		nop(2U);
+		write(config_register::idcode, idcode);
+		command(config_command::wcfg);
+		nop();
+	}
+
+	// start up sequence and desync.
+	void finish()
+	{
+		command(config_command::grestore);
+		nop();
+		command(config_command::dghigh);
+		nop(100U);
+		command(config_command::start);
+		nop();
+		write(config_register::far, final_address);
+		write_crc();
+		command(config_command::desync);
+		nop(16U);
+	}
+};
+
+// true if the frame after index starts a new row (or block type/half), which
+// is where the configuration logic expects padding frames.
+static bool ends_row(const frame_memory &frames, size_t index)
+{
+	constexpr uint32_t row_mask = 0xFFFE0000U;
+	return index + 1U >= frames.frame_count() ||
+	       (frames.addresses[index] & row_mask) !=
+	         (frames.addresses[index + 1U] & row_mask);
+}
+
+std::vector<uint8_t> write_bitstream(const frame_memory &frames)
+{
+	size_t padding = 0U;
+	for (size_t i = 0U; i < frames.frame_count(); ++i)
+		if (ends_row(frames, i)) padding += row_padding_frames;
+	const size_t data_words = (frames.frame_count() + padding) * words_per_frame;
+
+	std::vector<uint8_t> result;
+	result.reserve((data_words + packet_overhead_words) * sizeof(uint32_t));
+	packet_writer writer{.out = result};
+
+	writer.begin(frames.idcode);
+
+	// every frame in one auto-incrementing write.
+	writer.write(config_register::far,
+	             frames.frame_count() > 0U ? frames.addresses[0U] : 0U);
+	writer.begin_long_write(config_register::fdri, data_words);
+	// untouched frames all share the default page, so its ECC only needs
+	// computing once.
+	const uint32_t default_ecc = frame_ecc(frames.default_frame());
+	for (size_t i = 0U; i < frames.frame_count(); ++i)
+	{
+		writer.frame(frames.frame(i),
+		             frames.is_default(i) ? default_ecc
+		                                  : frame_ecc(frames.frame(i)));
+		if (ends_row(frames, i)) writer.padding_frames(row_padding_frames);
+	}
+
+	writer.finish();
+
+	ASSERT_LESS_OR_EQUAL(
+	  result.size(), (data_words + packet_overhead_words) * sizeof(uint32_t));
+
+	return result;
+}
+
+/* --- compressed --- */
+
+// word-wise hash of a frame, two words per multiply.
+static uint64_t frame_hash(lak::span<const uint32_t> frame)
+{
+	uint64_t hash = 0x9E3779B97F4A7C15U;
+	size_t i      = 0U;
+	for (; i + 1U < words_per_frame; i += 2U)
+	{
+		hash ^= uint64_t(frame[i]) | (uint64_t(frame[i + 1U]) << 32U);
+		hash *= 0xBF58476D1CE4E5B9U;
+		hash ^= hash >> 29U;
+	}
+	if (i < words_per_frame)
+	{
+		hash ^= frame[i];
+		hash *= 0xBF58476D1CE4E5B9U;
+		hash ^= hash >> 29U;
+	}
+	return hash;
+}
+
+struct frame_group
+{
+	// every frame with this content, in address order.
+	std::vector<uint32_t> frames;
+	// next group with the same hash.
+	size_t next = SIZE_MAX;
+};
+
+static std::vector<frame_group> group_frames(const frame_memory &frames)
+{
+	std::vector<frame_group> groups;
+	std::unordered_map<uint64_t, size_t> heads;
+	heads.reserve(frames.frame_count());
+
+	// untouched frames share the default page, once one of them has found its
+	// group the rest can skip hashing and comparing.
+	size_t default_group = SIZE_MAX;
+
+	for (size_t i = 0U; i < frames.frame_count(); ++i)
+	{
+		if (frames.is_default(i) && default_group != SIZE_MAX)
+		{
+			groups[default_group].frames.push_back(uint32_t(i));
+			continue;
+		}
+
+		const lak::span<const uint32_t> frame = frames.frame(i);
+
+		auto [it, inserted] =
+		  heads.try_emplace(frame_hash(frame), groups.size());
+		size_t group = it->second;
+
+		// hashes only pick the candidates, the contents must match exactly.
+		if (!inserted)
+		{
+			for (;;)
+			{
+				const lak::span<const uint32_t> other =
+				  frames.frame(groups[group].frames.front());
+				if (std::equal(frame.begin(), frame.end(), other.begin())) break;
+				if (groups[group].next == SIZE_MAX)
+				{
+					groups[group].next = groups.size();
+					group              = groups.size();
+					break;
+				}
+				group = groups[group].next;
+			}
+		}
+
+		if (group == groups.size()) groups.emplace_back();
+		groups[group].frames.push_back(uint32_t(i));
+		if (frames.is_default(i)) default_group = group;
+	}
+
+	return groups;
+}
+
+std::vector<uint8_t> write_compressed_bitstream(const frame_memory &frames)
+{
+	const std::vector<frame_group> groups = group_frames(frames);
+
+	std::vector<bool> repeated(frames.frame_count(), false);
+	size_t data_words = 0U;
+	for (const auto &group : groups)
+	{
+		if (group.frames.size() < 2U) continue;
+		for (const uint32_t index : group.frames) repeated[index] = true;
+		data_words += 4U + words_per_frame +
+		              (group.frames.size() * (3U + mfwr_dummy_words));
+	}
+
+	// runs of consecutive unrepeated frames within a row, each written with a
+	// single FAR + FDRI.
+	struct frame_run
+	{
+		size_t begin;
+		size_t end;
+	};
+	std::vector<frame_run> runs;
+	for (size_t i = 0U; i < frames.frame_count(); ++i)
+	{
+		if (repeated[i]) continue;
+		if (runs.empty() || runs.back().end != i || ends_row(frames, i - 1U))
+			runs.push_back({.begin = i, .end = i});
+		++runs.back().end;
+	}
+	for (const auto &run : runs)
+		data_words +=
+		  4U + ((run.end - run.begin + row_padding_frames) * words_per_frame);
+
+	std::vector<uint8_t> result;
+	result.reserve((data_words + packet_overhead_words) * sizeof(uint32_t));
+	packet_writer writer{.out = result};
+
+	writer.begin(frames.idcode);
+
+	for (const auto &run : runs)
+	{
+		writer.write(config_register::far, frames.addresses[run.begin]);
+		writer.begin_long_write(
+		  config_register::fdri,
+		  (run.end - run.begin + row_padding_frames) * words_per_frame);
+		for (size_t i = run.begin; i < run.end; ++i)
+			writer.frame(frames.frame(i), frame_ecc(frames.frame(i)));
+		writer.padding_frames(row_padding_frames);
+	}
+
+	// load each repeated frame once and copy it to every address it appears at.
+	for (const auto &group : groups)
+	{
+		if (group.frames.size() < 2U) continue;
+		writer.command(config_command::mfw);
+		writer.begin_long_write(config_register::fdri, words_per_frame);
+		const lak::span<const uint32_t> frame =
+		  frames.frame(group.frames.front());
+		writer.frame(frame, frame_ecc(frame));
+		for (const uint32_t index : group.frames)
+			writer.multi_frame_write(frames.addresses[index]);
+	}
+
+	writer.finish();
+
+	ASSERT_LESS_OR_EQUAL(
+	  result.size(), (data_words + packet_overhead_words) * sizeof(uint32_t));
+
+	return result;
+}
+
+/* --- reading back --- */
+
+struct packet_reader
+{
+	lak::span<const uint8_t> in;
+	frame_memory &frames;
+	bitstream_image &image;
+
+	size_t position = 0U; // in words
+	uint32_t crc    = 0U;
+	uint64_t step   = 0U;
+
+	// frame the next FDRI frame goes to, SIZE_MAX if FAR isn't a frame.
+	size_t cursor     = SIZE_MAX;
+	bool multi_frame  = false;
+	bool desynced     = false;
+	std::array<uint32_t, words_per_frame> multi_frame_buffer = {};
+	// how many times each frame has been written.
+	std::vector<uint8_t> write_counts;
+
+	size_t word_count() const { return in.size() / sizeof(uint32_t); }
+
+	uint32_t word_at(size_t index) const
+	{
+		const uint8_t *bytes = in.data() + (index * sizeof(uint32_t));
+		return (uint32_t(bytes[0]) << 24U) | (uint32_t(bytes[1]) << 16U) |
+		       (uint32_t(bytes[2]) << 8U) | uint32_t(bytes[3]);
+	}
+
+	void data(config_register reg, uint32_t value)
+	{
+		crc = config_crc(crc, uint32_t(reg), value);
+		++step;
+	}
+
+	void store_frame(size_t index, lak::span<const uint32_t> words)
+	{
+		if (write_counts[index] < UINT8_MAX) ++write_counts[index];
+
+		// the ECC bits are regenerated when the frame is written out again.
+		uint32_t any = 0U;
+		for (size_t i = 0U; i < words_per_frame; ++i)
+			any |= i == 0x32U ? words[i] & 0xFFFFE000U : words[i];
+		if (any == 0U && frames.is_default(index)) return;
+
+		const lak::span<uint32_t> frame = frames.write_frame(index);
+		std::copy(words.begin(), words.end(), frame.begin());
+		frame[0x32U] &= 0xFFFFE000U;
+	}
+
+	lak::result<lak::monostate> fdri(size_t count)
+	{
+		// the type 1 header in front of a type 2 long write.
+		if (count == 0U) return lak::ok_t{};
+
+		if (count % words_per_frame != 0U)
+		{
+			user_error("FDRI write of ",
+			           count,
+			           " words isn't a whole number of frames");
+			return lak::err_t{};
+		}
+
+		std::array<uint32_t, words_per_frame> words;
+
+		if (multi_frame)
+		{
+			if (count != words_per_frame)
+			{
+				user_error("Expected a single frame after MFW, got ",
+				           count / words_per_frame);
+				return lak::err_t{};
+			}
+			for (size_t i = 0U; i < words_per_frame; ++i)
+			{
+				multi_frame_buffer[i] = word_at(position++);
+				data(config_register::fdri, multi_frame_buffer[i]);
+			}
+			multi_frame = false;
+			return lak::ok_t{};
+		}
+
+		// frames go out in auto-increment order, with padding frames after the
+		// last frame of each row and at the end of every write.
+		size_t padding = 0U;
+		for (size_t left = count / words_per_frame; left > 0U; --left)
+		{
+			if (padding > 0U || left <= row_padding_frames)
+			{
+				if (padding > 0U) --padding;
+				for (size_t i = 0U; i < words_per_frame; ++i)
+					data(config_register::fdri, word_at(position++));
+				continue;
+			}
+
+			if (cursor >= frames.frame_count())
+			{
+				user_error("FDRI write past the last frame of the part");
+				return lak::err_t{};
+			}
+
+			image.frame_offsets[cursor] = position * sizeof(uint32_t);
+			image.frame_steps[cursor]   = step;
+			for (size_t i = 0U; i < words_per_frame; ++i)
+				data(config_register::fdri, words[i] = word_at(position++));
+			store_frame(cursor, lak::span<const uint32_t>(words));
+
+			if (ends_row(frames, cursor)) padding = row_padding_frames;
+			++cursor;
+		}
+
+		return lak::ok_t{};
+	}
+
+	lak::result<lak::monostate> write(config_register reg, size_t count)
+	{
+		if (reg == config_register::fdri) return fdri(count);
+
+		if (reg == config_register::mfwr && count > 0U)
+		{
+			if (cursor >= frames.frame_count())
+			{
+				user_error("MFWR to an address that isn't a frame of the part");
+				return lak::err_t{};
+			}
+			store_frame(cursor, lak::span<const uint32_t>(multi_frame_buffer));
+		}
+
+		for (size_t i = 0U; i < count; ++i)
+		{
+			const uint32_t value = word_at(position++);
+
+			if (reg == config_register::crc)
+			{
+				if (value != crc)
+				{
+					user_error("Bitstream CRC mismatch, expected 0x",
+					           std::hex,
+					           crc,
+					           " got 0x",
+					           value,
+					           std::dec);
+					return lak::err_t{};
+				}
+				image.crc_events.push_back(
+				  {.step = step, .offset = (position - 1U) * sizeof(uint32_t)});
+				crc = 0U;
+				continue;
+			}
+
+			data(reg, value);
+
+			switch (reg)
+			{
+				case config_register::far:
+					if_let_ok (const size_t index, frames.frame_index(value))
+						cursor = index;
+					else
+						cursor = SIZE_MAX;
+					break;
+
+				case config_register::idcode:
+					if (value != frames.idcode)
+					{
+						user_error("Bitstream is for IDCODE 0x",
+						           std::hex,
+						           value,
+						           ", the part's is 0x",
+						           frames.idcode,
+						           std::dec);
+						return lak::err_t{};
+					}
+					break;
+
+				case config_register::cmd:
+					if (value == uint32_t(config_command::rcrc))
+					{
+						crc = 0U;
+						image.crc_events.push_back(
+						  {.step = step, .offset = bitstream_image::no_offset});
+					}
+					else if (value == uint32_t(config_command::mfw))
+						multi_frame = true;
+					else if (value == uint32_t(config_command::desync))
+						desynced = true;
+					break;
+
+				default: break;
+			}
+		}
+
+		return lak::ok_t{};
+	}
+
+	lak::result<lak::monostate> read()
+	{
+		while (position < word_count() && word_at(position) != sync_word)
+			++position;
+		if (position == word_count())
+		{
+			user_error("No sync word in bitstream");
+			return lak::err_t{};
+		}
+		++position;
+
+		config_register reg = config_register::crc;
+		while (!desynced && position < word_count())
+		{
+			const uint32_t header = word_at(position++);
+			const uint32_t type   = header >> 29U;
+			const uint32_t op     = (header >> 27U) & 0x3U;
+
+			size_t count;
+			if (type == 1U)
+			{
+				reg   = config_register((header >> 13U) & 0x3FFFU);
+				count = header & 0x7FFU;
+			}
+			else if (type == 2U)
+				count = header & 0x7FFFFFFU;
+			else
+			{
+				user_error("Unknown packet header 0x", std::hex, header, std::dec);
+				return lak::err_t{};
+			}
+
+			if (count > word_count() - position)
+			{
+				user_error("Bitstream ends in the middle of a packet");
+				return lak::err_t{};
+			}
+
+			if (op == 0U)
+			{
+				// NOP
+				position += count;
+				continue;
+			}
+			if (op != 2U)
+			{
+				user_error("Unexpected read packet in bitstream");
+				return lak::err_t{};
+			}
+
+			RES_TRY(write(reg, count));
+		}
+
+		if (!desynced)
+		{
+			user_error("Bitstream ends without a DESYNC");
+			return lak::err_t{};
+		}
+
+		// frames written more than once can't be patched in place.
+		for (size_t i = 0U; i < frames.frame_count(); ++i)
+			if (write_counts[i] != 1U)
+				image.frame_offsets[i] = bitstream_image::no_offset;
+
+		return lak::ok_t{};
+	}
+};
+
+lak::result<bitstream_image> read_bitstream(lak::span<const uint8_t> bytes,
+                                            frame_memory &frames)
+{
+	bitstream_image image;
+	image.bytes.assign(bytes.begin(), bytes.end());
+	image.frame_offsets.assign(frames.frame_count(),
+	                           bitstream_image::no_offset);
+	image.frame_steps.assign(frames.frame_count(), 0U);
+
+	packet_reader reader{.in = bytes, .frames = frames, .image = image};
+	reader.write_counts.assign(frames.frame_count(), 0U);
+	RES_TRY(reader.read());
+
+	return lak::ok_t{lak::move(image)};
+}
+
+// config_crc(crc, 0, 0) applied count times. the step is linear in crc so
+// it's a 32x32 matrix over GF(2), its powers of 2 are built once and count
+// steps take at most 64 matrix-vector products.
+static uint32_t crc_zero_steps(uint32_t crc, uint64_t count)
+{
+	using matrix = std::array<uint32_t, 32U>;
+
+	static const std::array<matrix, 64U> powers = []
+	{
+		const auto apply = [](const matrix &m, uint32_t v)
+		{
+			uint32_t result = 0U;
+			for (uint32_t bit = 0U; v != 0U; ++bit, v >>= 1U)
+				if (v & 1U) result ^= m[bit];
+			return result;
+		};
+
+		std::array<matrix, 64U> result;
+		for (uint32_t bit = 0U; bit < 32U; ++bit)
+			result[0U][bit] = config_crc(uint32_t(1U) << bit, 0U, 0U);
+		for (size_t i = 1U; i < result.size(); ++i)
+			for (uint32_t bit = 0U; bit < 32U; ++bit)
+				result[i][bit] = apply(result[i - 1U], result[i - 1U][bit]);
+		return result;
+	}();
+
+	for (size_t i = 0U; count != 0U; ++i, count >>= 1U)
+	{
+		if ((count & 1U) == 0U) continue;
+		uint32_t result = 0U;
+		for (uint32_t bit = 0U; crc != 0U; ++bit, crc >>= 1U)
+			if (crc & 1U) result ^= powers[i][bit];
+		crc = result;
+	}
+	return crc;
+}
+
+lak::result<lak::monostate> patch_bitstream(
+  bitstream_image &image,
+  const frame_memory &frames,
+  lak::span<const uint32_t> changed)
+{
+	for (const uint32_t index : changed)
+		if (image.frame_offsets[index] == bitstream_image::no_offset)
+			return lak::err_t{};
+
+	const auto load = [&](size_t offset)
+	{
+		const uint8_t *bytes = image.bytes.data() + offset;
+		return (uint32_t(bytes[0]) << 24U) | (uint32_t(bytes[1]) << 16U) |
+		       (uint32_t(bytes[2]) << 8U) | uint32_t(bytes[3]);
+	};
+	const auto store = [&](size_t offset, uint32_t value)
+	{
+		uint8_t *bytes = image.bytes.data() + offset;
+		bytes[0]       = uint8_t(value >> 24U);
+		bytes[1]       = uint8_t(value >> 16U);
+		bytes[2]       = uint8_t(value >> 8U);
+		bytes[3]       = uint8_t(value);
+	};
+
+	// the CRC is linear, so the change in each check is the CRC of the
+	// changed words (xor old ^ new) carried forward to the check.
+	std::vector<uint32_t> check_deltas(image.crc_events.size(), 0U);
+
+	for (const uint32_t index : changed)
+	{
+		const lak::span<const uint32_t> frame = frames.frame(index);
+		const uint32_t ecc                    = frame_ecc(frame);
+		const size_t offset                   = image.frame_offsets[index];
+
+		uint32_t delta = 0U;
+		for (size_t i = 0U; i < words_per_frame; ++i)
+		{
+			const size_t word_offset = offset + (i * sizeof(uint32_t));
+			const uint32_t word =
+			  i == 0x32U ? (frame[i] & 0xFFFFE000U) | ecc : frame[i];
+			delta = config_crc(delta, 0U, load(word_offset) ^ word);
+			store(word_offset, word);
+		}
+		if (delta == 0U) continue;
+
+		const uint64_t last_step =
+		  image.frame_steps[index] + words_per_frame - 1U;
+		const auto event =
+		  std::upper_bound(image.crc_events.begin(),
+		                   image.crc_events.end(),
+		                   last_step,
+		                   [](uint64_t step, const bitstream_image::crc_event &e)
+		                   { return step < e.step; });
+		if (event == image.crc_events.end() ||
+		    event->offset == bitstream_image::no_offset)
+			continue;
+
+		check_deltas[size_t(event - image.crc_events.begin())] ^=
+		  crc_zero_steps(delta, event->step - last_step - 1U);
+	}
+
+	for (size_t i = 0U; i < image.crc_events.size(); ++i)
+		if (check_deltas[i] != 0U)
+			store(image.crc_events[i].offset,
+			      load(image.crc_events[i].offset) ^ check_deltas[i]);
+
+	return lak::ok_t{};
+}
+
+void bit_test()
+{
+	SCOPED_CHECKPOINT("Bitstream tests");
+
+	// two columns and a block ram column in the top half, one column in the
+	// bottom half.
+	const auto part =
+	  json_parser{
+	    R"({"idcode": 1, "global_clock_regions": {"top": {"rows": {"0": )"
+	    R"({"configuration_buses": {"CLB_IO_CLK": {"configuration_columns": )"
+	    R"({"0": {"frame_count": 4}, "1": {"frame_count": 4}}}, "BLOCK_RAM": )"
+	    R"({"configuration_columns": {"0": {"frame_count": 2}}}}}}}, )"
+	    R"("bottom": {"rows": {"0": {"configuration_buses": {"CLB_IO_CLK": )"
+	    R"({"configuration_columns": {"0": {"frame_count": 3}}}}}}}}})"_view}
+	    .parse();
+	ASSERT(part.is_ok());
+	const json_parser::value_type &part_root = part.unwrap().root;
+
+	const auto empty_frames = [&]
+	{
+		auto frames = frame_memory::from_part(part_root);
+		ASSERT(frames.is_ok());
+		return frames.unwrap();
+	};
+
+	// frames read back hold their ECC in word 0x32 as well.
+	const auto same_frames = [](const frame_memory &a, const frame_memory &b)
+	{
+		ASSERT_EQUAL(a.frame_count(), b.frame_count());
+		for (size_t i = 0U; i < a.frame_count(); ++i)
+			for (size_t w = 0U; w < words_per_frame; ++w)
+			{
+				const uint32_t mask = w == 0x32U ? 0xFFFFE000U : 0xFFFFFFFFU;
+				if ((a.frame(i)[w] & mask) != (b.frame(i)[w] & mask)) return false;
+			}
+		return true;
+	};
+
+	const auto read = [&](const std::vector<uint8_t> &bytes,
+	                      frame_memory &frames)
+	{ return read_bitstream(lak::span(bytes), frames); };
+
+	const auto patch = [](bitstream_image &image,
+	                      const frame_memory &frames,
+	                      const std::vector<uint32_t> &changed)
+	{
+		return patch_bitstream(image, frames, lak::span<const uint32_t>(changed));
+	};
+
+	// frames 0-3 and 4-7 are the top columns, 8-10 the bottom column and
+	// 11-12 the block ram column. 5 and 9 are identical, so the compressed
+	// writer replicates them with MFWR, as it does the untouched frames.
+	frame_memory frames = empty_frames();
+	ASSERT_EQUAL(frames.frame_count(), 13U);
+	frames.set_bit(1U, 3U, 7U, true);
+	frames.set_bit(1U, 100U, 31U, true);
+	frames.set_bit(5U, 50U, 20U, true);
+	frames.set_bit(9U, 50U, 20U, true);
+	frames.set_bit(11U, 0U, 0U, true);
+
+	{
+		const std::vector<uint8_t> bytes = write_bitstream(frames);
+
+		frame_memory read_frames = empty_frames();
+		auto image               = read(bytes, read_frames);
+		ASSERT(image.is_ok());
+		ASSERT(same_frames(read_frames, frames));
+
+		// every frame is written exactly once.
+		for (const size_t offset : image.unwrap().frame_offsets)
+			ASSERT_NOT_EQUAL(offset, bitstream_image::no_offset);
+
+		std::vector<uint8_t> corrupt = bytes;
+		corrupt[image.unwrap().frame_offsets[1] + 4U] ^= 1U;
+		frame_memory corrupt_frames = empty_frames();
+		ASSERT(read(corrupt, corrupt_frames).is_err());
+
+		read_frames.set_bit(1U, 3U, 7U, false);
+		read_frames.set_bit(5U, 7U, 3U, true);
+		ASSERT(patch(image.unwrap(), read_frames, {1U, 5U}).is_ok());
+		ASSERT(image.unwrap().bytes == write_bitstream(read_frames));
+
+		frame_memory patched_frames = empty_frames();
+		ASSERT(read(image.unwrap().bytes, patched_frames).is_ok());
+		ASSERT(same_frames(patched_frames, read_frames));
+	}
+
+	{
+		const std::vector<uint8_t> bytes = write_compressed_bitstream(frames);
+
+		frame_memory read_frames = empty_frames();
+		auto image               = read(bytes, read_frames);
+		ASSERT(image.is_ok());
+		ASSERT(same_frames(read_frames, frames));
+
+		const std::vector<size_t> &offsets = image.unwrap().frame_offsets;
+		ASSERT_NOT_EQUAL(offsets[1], bitstream_image::no_offset);
+		ASSERT_NOT_EQUAL(offsets[11], bitstream_image::no_offset);
+		ASSERT_EQUAL(offsets[0], bitstream_image::no_offset);
+		ASSERT_EQUAL(offsets[5], bitstream_image::no_offset);
+		ASSERT_EQUAL(offsets[9], bitstream_image::no_offset);
+
+		std::vector<uint8_t> corrupt = bytes;
+		corrupt[offsets[11] + 4U] ^= 1U;
+		frame_memory corrupt_frames = empty_frames();
+		ASSERT(read(corrupt, corrupt_frames).is_err());
+
+		// frames written once by FDRI are rewritten in place.
+		read_frames.set_bit(1U, 3U, 7U, false);
+		ASSERT(patch(image.unwrap(), read_frames, {1U}).is_ok());
+		ASSERT(image.unwrap().bytes == write_compressed_bitstream(read_frames));
+
+		frame_memory patched_frames = empty_frames();
+		ASSERT(read(image.unwrap().bytes, patched_frames).is_ok());
+		ASSERT(same_frames(patched_frames, read_frames));
+
+		// frames replicated by MFWR aren't, the image is left untouched for the
+		// caller to write the whole bitstream again.
+		const std::vector<uint8_t> before = image.unwrap().bytes;
+		read_frames.set_bit(5U, 7U, 3U, true);
+		ASSERT(patch(image.unwrap(), read_frames, {1U, 5U}).is_err());
+		ASSERT(image.unwrap().bytes == before);
+
+		frame_memory rewritten_frames = empty_frames();
+		ASSERT(read(write_compressed_bitstream(read_frames), rewritten_frames)
+		         .is_ok());
+		ASSERT(same_frames(rewritten_frames, read_frames));
+	}
+
+	DEBUG(LAK_GREEN "Bitstream tests complete" LAK_SGR_RESET);
+}
@@ -4,22 +4,19 @@
 
 csv_parser::result<lak::astring_view> csv_parser::parse_value()
 {
-	const char *begin = input.begin();
-
-	while (pop_not_char({',', '\n', '\r'}).is_ok())
-		;
+	static constexpr char_class delimiter = char_class::of(",\n\r");
 
-	return lak::ok_t{lak::astring_view(begin, input.begin())};
+	return lak::ok_t{skip_until<delimiter>()};
 }
 
 csv_parser::result<lak::astring_view> csv_parser::parse_newline()
 {
 	const char *begin = input.begin();
 
-	while (pop_char({'\r'}).is_ok())
+	while (pop_char<char_classes::one_of<'\r'>>().is_ok())
 		;
-	RES_TRY(pop_char({'\n'}));
-	while (pop_char({'\r'}).is_ok())
+	RES_TRY(pop_char<char_classes::one_of<'\n'>>());
+	while (pop_char<char_classes::one_of<'\r'>>().is_ok())
 		;
 
 	return lak::ok_t{lak::astring_view(begin, input.begin())};
@@ -29,12 +26,15 @@ csv_parser::result<csv_parser::line> csv_parser::parse_line()
 {
 	line result;
 
-	while (peek_char({'\n', '\r'}).is_err())
+	if (peek_char<char_classes::newline>().is_ok())
+		return lak::ok_t{lak::move(result)};
+
+	// a trailing ',' is followed by an empty value.
+	do
 	{
 		RES_TRY_ASSIGN(const lak::astring_view value =, parse_value());
 		result.values.push_back(value);
-		if (pop_char({','}).is_err()) break;
-	}
+	} while (pop_char<char_classes::one_of<','>>().is_ok());
 
 	return lak::ok_t{lak::move(result)};
 }
@@ -71,5 +71,42 @@ void csv_test()
 {
 	SCOPED_CHECKPOINT("CSV tests");
 
+	const auto view = [](const lak::astring &str)
+	{ return lak::astring_view(str.data(), str.data() + str.size()); };
+
+	{
+		const auto lines = csv_parser{"a,,b\r\nc,\n\nd,"_view}.parse();
+		ASSERT(lines.is_ok());
+		ASSERT_EQUAL(lines.unwrap().size(), 4U);
+		ASSERT_EQUAL(lak::streamify(lines.unwrap()[0]), "a,,b");
+		ASSERT_EQUAL(lines.unwrap()[0].values.size(), 3U);
+		ASSERT_EQUAL(lak::streamify(lines.unwrap()[1]), "c,");
+		ASSERT_EQUAL(lines.unwrap()[1].values.size(), 2U);
+		ASSERT(lines.unwrap()[2].values.empty());
+		ASSERT_EQUAL(lines.unwrap()[3].values.size(), 2U);
+		ASSERT(lines.unwrap()[3].values[1].empty());
+	}
+
+	// values either side of the 16 and 32 byte scans, with and without a
+	// final newline.
+	for (size_t length = 0U; length < 70U; ++length)
+	{
+		const lak::astring first(length, 'v');
+		const lak::astring second(69U - length, 'w');
+		const lak::astring line = first + "," + second;
+		const lak::astring input =
+		  line + "\r\n" + line + "\n" + line + (length % 2U ? "\n" : "");
+
+		const auto lines = csv_parser{view(input)}.parse();
+		ASSERT(lines.is_ok());
+		ASSERT_EQUAL(lines.unwrap().size(), 3U);
+		for (const auto &l : lines.unwrap())
+		{
+			ASSERT_EQUAL(l.values.size(), 2U);
+			ASSERT_EQUAL(l.values[0], view(first));
+			ASSERT_EQUAL(l.values[1], view(second));
+		}
+	}
+
 	DEBUG(LAK_GREEN "CSV tests complete" LAK_SGR_RESET);
 }
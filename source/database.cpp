@@ -1,27 +1,1731 @@
 #include "database.hpp"
 
 #include "fasm2bit.hpp"
+#include "json.hpp"
 
-lak::result<database> database::open(const fs::path &path,
-                                     lak::astring_view family,
-                                     lak::astring_view fabric,
-                                     lak::astring_view package)
+#include "lak/string_literals.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <unordered_set>
+
+/* --- tilegrid.json --- */
+
+static lak::result<uint32_t> parse_uint(lak::astring_view str, int base = 10)
+{
+	if (base == 16 && str.size() > 2U && str[0] == '0' &&
+	    (str[1] == 'x' || str[1] == 'X'))
+		str = str.substr(2U);
+
+	uint32_t result = 0U;
+	if (const auto [ptr, ec] =
+	      std::from_chars(str.begin(), str.end(), result, base);
+	    ec != std::errc{} || ptr != str.end())
+	{
+		user_error("Expected integer in tilegrid, got '", str, "'");
+		return lak::err_t{};
+	}
+	return lak::ok_t{result};
+}
+
+// streams tilegrid.json straight into database::tiles, tracking where in the
+// document each event is by depth:
+//   1 { tile name : 2 { "type" : ..., "bits" : 3 { bus : 4 { ... } } } }
+struct tilegrid_handler
+{
+	tilegrid &tiles;
+
+	size_t depth = 0U;
+	lak::astring_view last_key;
+	bool root_object = false;
+	bool failed      = false;
+
+	lak::astring_view tile_name;
+	lak::astring_view tile_type;
+	uint32_t grid_x = 0U;
+	uint32_t grid_y = 0U;
+	std::vector<tile_bus> tile_buses;
+	bool tile_open = false;
+	bool bits_open = false;
+
+	tile_bus current_bus;
+	bool bus_open = false;
+	static inline const lak::astring_view bus_keys[] = {
+	  "baseaddr"_view, "frames"_view, "offset"_view, "words"_view};
+	lak::astring_view bus_values[std::size(bus_keys)];
+
+	void fail()
+	{
+		if (!failed) user_error_cont("In tile ", tile_name);
+		failed = true;
+	}
+
+	void open_object()
+	{
+		if (depth == 0U)
+		{
+			root_object = true;
+		}
+		else if (depth == 1U)
+		{
+			tile_name = last_key;
+			tile_type = {};
+			grid_x    = 0U;
+			grid_y    = 0U;
+			tile_buses.clear();
+			tile_open = true;
+		}
+		else if (depth == 2U && tile_open && last_key == "bits"_view)
+		{
+			bits_open = true;
+		}
+		else if (depth == 3U && bits_open)
+		{
+			if_let_ok (const auto block,
+			           frame_address::parse_block_type(last_key))
+			{
+				current_bus = {.block = block};
+				bus_open    = true;
+				std::fill(std::begin(bus_values), std::end(bus_values), ""_view);
+			}
+			else
+				fail();
+		}
+	}
+
+	void close_object()
+	{
+		if (depth == 3U && bus_open)
+		{
+			bus_open = false;
+			if (end_bus().is_err()) fail();
+		}
+		else if (depth == 2U && bits_open)
+		{
+			bits_open = false;
+		}
+		else if (depth == 1U && tile_open)
+		{
+			tile_open = false;
+			if (tile_type.empty())
+			{
+				user_error("Expected string 'type' in tilegrid");
+				fail();
+			}
+			else
+			{
+				const tile_id id =
+				  tiles.insert(symbol_table::global().intern(tile_name),
+				               symbol_table::global().intern(tile_type),
+				               grid_x,
+				               grid_y);
+				for (const tile_bus &bus : tile_buses) tiles.set_bus(id, bus);
+			}
+		}
+	}
+
+	// once failed the rest of the document is only walked, not loaded.
+	void start_object()
+	{
+		if (!failed) open_object();
+		++depth;
+	}
+
+	void end_object()
+	{
+		--depth;
+		if (!failed) close_object();
+	}
+
+	void start_array() { ++depth; }
+	void end_array() { --depth; }
+
+	void key(lak::astring_view key) { last_key = key; }
+
+	void string(lak::astring_view value)
+	{
+		if (!failed && depth == 2U && tile_open && last_key == "type"_view &&
+		    tile_type.empty())
+			tile_type = value;
+		else
+			literal(value);
+	}
+
+	void literal(lak::astring_view value)
+	{
+		if (failed) return;
+
+		// grid coordinates are optional, they default to 0.
+		if (depth == 2U && tile_open)
+		{
+			uint32_t *coord = last_key == "grid_x"_view   ? &grid_x
+			                  : last_key == "grid_y"_view ? &grid_y
+			                                              : nullptr;
+			if (!coord) return;
+			if_let_ok (const uint32_t c, parse_uint(value))
+				*coord = c;
+			else
+				fail();
+			return;
+		}
+
+		if (depth != 4U || !bus_open) return;
+		for (size_t i = 0U; i < std::size(bus_keys); ++i)
+			if (last_key == bus_keys[i] && bus_values[i].empty())
+				bus_values[i] = value;
+	}
+
+	lak::result<lak::monostate> end_bus()
+	{
+		for (size_t i = 0U; i < std::size(bus_keys); ++i)
+			if (bus_values[i].empty())
+			{
+				user_error("Expected integer '", bus_keys[i], "' in tilegrid");
+				return lak::err_t{};
+			}
+
+		RES_TRY_ASSIGN(current_bus.base_address =, parse_uint(bus_values[0], 16));
+		RES_TRY_ASSIGN(current_bus.frame_count =, parse_uint(bus_values[1]));
+		RES_TRY_ASSIGN(current_bus.word_offset =, parse_uint(bus_values[2]));
+		RES_TRY_ASSIGN(current_bus.word_count =, parse_uint(bus_values[3]));
+		tile_buses.push_back(current_bus);
+		return lak::ok_t{};
+	}
+};
+
+/* --- tilegrid --- */
+
+size_t tilegrid::probe(symbol_id name) const
+{
+	const size_t mask = _index.size() - 1U;
+	for (size_t index = size_t(uint32_t(name * 0x9E3779B1U)) & mask;;
+	     index        = (index + 1U) & mask)
+		if (_index[index].name == name || _index[index].name == empty_entry)
+			return index;
+}
+
+void tilegrid::rehash(size_t entry_count)
+{
+	std::vector<index_entry> old = lak::move(_index);
+	_index.assign(entry_count, index_entry{});
+	for (const index_entry &e : old)
+		if (e.name != empty_entry) _index[probe(e.name)] = e;
+}
+
+void tilegrid::reserve(size_t tile_count)
+{
+	names.reserve(tile_count);
+	types.reserve(tile_count);
+	type_indices.reserve(tile_count);
+	grid_x.reserve(tile_count);
+	grid_y.reserve(tile_count);
+	bus_masks.reserve(tile_count);
+	if (tile_count * 2U > _index.size())
+		rehash(std::bit_ceil(std::max<size_t>(tile_count * 2U, 64U)));
+}
+
+uint32_t tilegrid::type_index(symbol_id type)
+{
+	auto [it, inserted] =
+	  _type_index.try_emplace(type, uint32_t(type_names.size()));
+	if (inserted)
+	{
+		type_names.push_back(type);
+		for (auto &column : type_segbits) column.push_back(nullptr);
+		type_segbits_set.push_back(0U);
+	}
+	return it->second;
+}
+
+tile_id tilegrid::insert(symbol_id name,
+                         symbol_id type,
+                         uint32_t x,
+                         uint32_t y)
+{
+	if ((size() + 1U) * 2U > _index.size())
+		rehash(std::max<size_t>(_index.size() * 2U, 64U));
+
+	index_entry &e = _index[probe(name)];
+	if (e.name == empty_entry)
+	{
+		e.name = name;
+		e.tile = tile_id(size());
+		names.push_back(name);
+		types.push_back(type);
+		type_indices.push_back(type_index(type));
+		grid_x.push_back(x);
+		grid_y.push_back(y);
+		bus_masks.push_back(0U);
+		for (bus_columns &columns : buses)
+		{
+			columns.base_address.push_back(0U);
+			columns.frame_count.push_back(0U);
+			columns.word_offset.push_back(0U);
+			columns.word_count.push_back(0U);
+		}
+	}
+	else
+	{
+		types[e.tile]        = type;
+		type_indices[e.tile] = type_index(type);
+		grid_x[e.tile]       = x;
+		grid_y[e.tile]       = y;
+		bus_masks[e.tile]    = 0U;
+	}
+	return e.tile;
+}
+
+void tilegrid::set_bus(tile_id tile, const tile_bus &bus)
+{
+	bus_columns &columns       = buses[size_t(bus.block)];
+	columns.base_address[tile] = bus.base_address;
+	columns.frame_count[tile]  = bus.frame_count;
+	columns.word_offset[tile]  = bus.word_offset;
+	columns.word_count[tile]   = bus.word_count;
+	bus_masks[tile] |= uint8_t(1U << size_t(bus.block));
+}
+
+lak::optional<tile_bus> tilegrid::bus(tile_id tile,
+                                      frame_address::block_type block) const
+{
+	if ((bus_masks[tile] & (1U << size_t(block))) == 0U)
+		return lak::optional<tile_bus>{};
+	const bus_columns &columns = buses[size_t(block)];
+	return lak::optional<tile_bus>{tile_bus{
+	  .block        = block,
+	  .base_address = columns.base_address[tile],
+	  .frame_count  = columns.frame_count[tile],
+	  .word_offset  = columns.word_offset[tile],
+	  .word_count   = columns.word_count[tile],
+	}};
+}
+
+lak::optional<tile_id> tilegrid::find(symbol_id name) const
+{
+	if (_index.empty()) return lak::optional<tile_id>{};
+	const index_entry &e = _index[probe(name)];
+	if (e.name == empty_entry) return lak::optional<tile_id>{};
+	return lak::optional<tile_id>{e.tile};
+}
+
+lak::optional<tile_id> tilegrid::find(lak::astring_view name) const
+{
+	if (const auto id = symbol_table::global().find(name); id)
+		return find(*id);
+	return lak::optional<tile_id>{};
+}
+
+/* --- tile_segbits --- */
+
+size_t tile_segbits::probe(symbol_id feature) const
+{
+	// fibonacci hashing, the ids are dense so consecutive ids spread out.
+	const size_t mask = entries.size() - 1U;
+	for (size_t index = size_t(uint32_t(feature * 0x9E3779B1U)) & mask;;
+	     index        = (index + 1U) & mask)
+		if (entries[index].feature == feature ||
+		    entries[index].feature == empty_entry)
+			return index;
+}
+
+void tile_segbits::rehash(size_t entry_count)
+{
+	std::vector<entry> old = lak::move(entries);
+	entries.assign(entry_count, entry{});
+	for (const entry &e : old)
+		if (e.feature != empty_entry) entries[probe(e.feature)] = e;
+}
+
+void tile_segbits::insert(symbol_id feature,
+                          lak::span<const segbit> feature_bits)
+{
+	if ((feature_count + 1U) * 2U > entries.size())
+		rehash(std::max<size_t>(entries.size() * 2U, 64U));
+
+	entry &e = entries[probe(feature)];
+	if (e.feature == empty_entry) ++feature_count;
+	e.feature = feature;
+	e.begin   = uint32_t(bits.size());
+	bits.insert(bits.end(), feature_bits.begin(), feature_bits.end());
+	e.end = uint32_t(bits.size());
+}
+
+lak::result<lak::span<const segbit>> tile_segbits::find(
+  symbol_id feature) const
+{
+	if (entries.empty()) return lak::err_t{};
+	const entry &e = entries[probe(feature)];
+	if (e.feature == empty_entry) return lak::err_t{};
+	return lak::ok_t{
+	  lak::span<const segbit>(bits.data() + e.begin, e.end - e.begin)};
+}
+
+size_t tile_segbits::probe_indexed(symbol_id base, uint32_t index) const
+{
+	const size_t mask = indexed_entries.size() - 1U;
+	for (size_t i = size_t(uint32_t((base ^ (index * 0x85EBCA6BU)) *
+	                                0x9E3779B1U)) &
+	                mask;;
+	     i = (i + 1U) & mask)
+	{
+		const indexed_entry &e = indexed_entries[i];
+		if ((e.base == base && e.index == index) || e.base == empty_entry)
+			return i;
+	}
+}
+
+void tile_segbits::rehash_indexed(size_t entry_count)
+{
+	std::vector<indexed_entry> old = lak::move(indexed_entries);
+	indexed_entries.assign(entry_count, indexed_entry{});
+	for (const indexed_entry &e : old)
+		if (e.base != empty_entry)
+			indexed_entries[probe_indexed(e.base, e.index)] = e;
+}
+
+void tile_segbits::insert_indexed(symbol_id base,
+                                  uint32_t index,
+                                  symbol_id feature)
+{
+	if ((indexed_count + 1U) * 2U > indexed_entries.size())
+		rehash_indexed(std::max<size_t>(indexed_entries.size() * 2U, 64U));
+
+	indexed_entry &e = indexed_entries[probe_indexed(base, index)];
+	if (e.base == empty_entry) ++indexed_count;
+	e.base    = base;
+	e.index   = index;
+	e.feature = feature;
+}
+
+lak::result<lak::span<const segbit>> tile_segbits::find(symbol_id base,
+                                                        uint32_t index) const
+{
+	if (indexed_entries.empty()) return lak::err_t{};
+	const indexed_entry &e = indexed_entries[probe_indexed(base, index)];
+	if (e.base == empty_entry) return lak::err_t{};
+	return find(e.feature);
+}
+
+/* --- segbits_*.db --- */
+
+static lak::astring to_upper(lak::astring str)
+{
+	std::transform(str.begin(),
+	               str.end(),
+	               str.begin(),
+	               [](char c)
+	               { return c >= 'a' && c <= 'z' ? char(c - 'a' + 'A') : c; });
+	return str;
+}
+
+// "segbits_bram_l.block_ram.db" -> "BRAM_L.BLOCK_RAM", empty if path is not a
+// segbits file.
+static lak::astring segbits_key(const fs::path &path)
+{
+	const lak::astring_view prefix = "segbits_"_view;
+	const lak::astring_view suffix = ".db"_view;
+
+	const lak::astring name = path.filename().string();
+	if (name.size() <= prefix.size() + suffix.size() ||
+	    name.compare(0U, prefix.size(), prefix.begin(), prefix.size()) != 0 ||
+	    name.compare(name.size() - suffix.size(),
+	                 suffix.size(),
+	                 suffix.begin(),
+	                 suffix.size()) != 0)
+		return {};
+
+	lak::astring key = to_upper(name.substr(
+	  prefix.size(), name.size() - prefix.size() - suffix.size()));
+
+	// other annotated copies of the segbits (e.g. ".origin_info") are skipped.
+	if (const size_t dot = key.find('.');
+	    dot != lak::astring::npos && key.substr(dot) != ".BLOCK_RAM")
+		return {};
+
+	return key;
+}
+
+// inserts the feature and, if its name is FEATURE[n], indexes it by
+// (FEATURE, n). n is compared as a number, "INIT[05]" is bit 5.
+static void insert_feature(tile_segbits &segbits,
+                           lak::astring_view name,
+                           symbol_id feature,
+                           lak::span<const segbit> bits)
+{
+	segbits.insert(feature, bits);
+
+	if (name.size() < 3U || name.end()[-1] != ']') return;
+	const char *open = name.end() - 1;
+	while (open != name.begin() && open[-1] != '[') --open;
+	if (open == name.begin() || open - 1 == name.begin()) return;
+
+	uint32_t index = 0U;
+	if (const auto [ptr, ec] = std::from_chars(open, name.end() - 1, index);
+	    ec != std::errc{} || ptr != name.end() - 1)
+		return;
+
+	segbits.insert_indexed(symbol_table::global().intern(
+	                         lak::astring_view(name.begin(), open - 1)),
+	                       index,
+	                       feature);
+}
+
+static lak::result<tile_segbits> load_segbits(const fs::path &path)
+{
+	RES_TRY_ASSIGN(const mapped_file file =,
+	               map_file(path).map_err(
+	                 [&](const auto &err) -> lak::monostate
+	                 {
+		                 user_error("Failed to open ", path, ": ", err);
+		                 return {};
+	                 }));
+
+	tile_segbits result;
+
+	segbits_parser parser{file.view()};
+	RES_TRY(parser
+	          .parse(
+	            [&](segbits_parser::line &&line)
+	            {
+		            // strip the "TILE_TYPE." prefix.
+		            lak::astring_view feature = line.feature;
+		            if (const auto dot = std::find(
+		                  feature.begin(), feature.end(), '.');
+		                dot != feature.end())
+			            feature = lak::astring_view(dot + 1, feature.end());
+		            insert_feature(result,
+		                           feature,
+		                           symbol_table::global().intern(feature),
+		                           lak::span(line.bits));
+	            })
+	          .map_err(
+	            [&](const auto &err) -> lak::monostate
+	            {
+		            user_error("Failed to parse ",
+		                       path,
+		                       ":",
+		                       std::count(file.view().begin(),
+		                                  parser.input.begin(),
+		                                  '\n') +
+		                         1,
+		                       ": ",
+		                       err);
+		            return {};
+	            }));
+
+	return lak::ok_t{lak::move(result)};
+}
+
+/* --- cache --- */
+
+static uint64_t mix(uint64_t hash, uint64_t value)
+{
+	hash ^= value;
+	hash *= 0xBF58476D1CE4E5B9U;
+	hash ^= hash >> 29U;
+	return hash;
+}
+
+// word-wise so validating a large section stays cheap.
+static uint64_t cache_checksum(const void *data, size_t size)
+{
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	uint64_t hash        = 0x9E3779B97F4A7C15U;
+	size_t i             = 0U;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(word));
+		hash = mix(hash, word);
+	}
+	for (; i < size; ++i) hash = mix(hash, bytes[i]);
+	return hash;
+}
+
+template<typename T>
+static uint64_t cache_checksum(lak::span<const T> records)
+{
+	return cache_checksum(records.data(), records.size() * sizeof(T));
+}
+
+static uint64_t cache_checksum(const database_cache::header &head)
+{
+	database_cache::header unsummed = head;
+	unsummed.checksum               = 0U;
+	return cache_checksum(&unsummed, sizeof(unsummed));
+}
+
+static uint64_t cache_checksum(
+  lak::span<const database_cache::feature_record> features,
+  lak::span<const database_cache::bit_record> bits)
+{
+	return mix(cache_checksum(features), cache_checksum(bits));
+}
+
+static lak::result<uint64_t> source_fingerprint(
+  const fs::path &tilegrid_path,
+  const std::unordered_map<lak::astring, database::segbits_file> &files)
+{
+	std::vector<const fs::path *> paths;
+	paths.reserve(files.size() + 1U);
+	paths.push_back(&tilegrid_path);
+	for (const auto &[key, file] : files) paths.push_back(&file.path);
+	// directory iteration order is unspecified.
+	std::sort(paths.begin() + 1,
+	          paths.end(),
+	          [](const fs::path *a, const fs::path *b) { return *a < *b; });
+
+	uint64_t hash = mix(0U, database_cache::version);
+	for (const fs::path *path : paths)
+	{
+		std::error_code ec;
+		const uintmax_t size = fs::file_size(*path, ec);
+		if (ec)
+		{
+			user_error("Failed to read ", *path, ": ", ec.message());
+			return lak::err_t{};
+		}
+		const auto time = fs::last_write_time(*path, ec);
+		if (ec)
+		{
+			user_error("Failed to read ", *path, ": ", ec.message());
+			return lak::err_t{};
+		}
+
+		const lak::astring name = path->string();
+		hash = mix(hash, symbol_hash(lak::astring_view(
+		                   name.data(), name.data() + name.size())));
+		hash = mix(hash, size);
+		hash = mix(hash, uint64_t(time.time_since_epoch().count()));
+	}
+	return lak::ok_t{hash};
+}
+
+// checked is false for the sections that are checksummed piecewise.
+template<typename T>
+static lak::result<lak::span<const T>> cache_section(
+  lak::span<const char> file,
+  const database_cache::section &section,
+  bool checked = true)
+{
+	if (section.offset % alignof(T) != 0U || section.offset > file.size() ||
+	    section.count > (file.size() - section.offset) / sizeof(T))
+		return lak::err_t{};
+	const lak::span<const T> result(
+	  reinterpret_cast<const T *>(file.data() + section.offset),
+	  size_t(section.count));
+	if (checked && cache_checksum(result) != section.checksum)
+		return lak::err_t{};
+	return lak::ok_t{result};
+}
+
+lak::result<database_cache> database_cache::view(lak::span<const char> file,
+                                                 uint64_t fingerprint)
+{
+	database_cache result;
+
+	if (file.size() < sizeof(header)) return lak::err_t{};
+	header head;
+	std::memcpy(&head, file.data(), sizeof(head));
+
+	if (!std::equal(std::begin(head.magic), std::end(head.magic), magic) ||
+	    head.version != version || head.file_size != file.size() ||
+	    head.fingerprint != fingerprint)
+		return lak::err_t{};
+
+	if (head.checksum != cache_checksum(head)) return lak::err_t{};
+
+	RES_TRY_ASSIGN(result.strings =, cache_section<char>(file, head.strings));
+	RES_TRY_ASSIGN(result.symbols =,
+	               cache_section<symbol_record>(file, head.symbols));
+	RES_TRY_ASSIGN(result.tiles =, cache_section<tile_record>(file, head.tiles));
+	RES_TRY_ASSIGN(result.buses =, cache_section<bus_record>(file, head.buses));
+	RES_TRY_ASSIGN(result.segbits_files =,
+	               cache_section<segbits_record>(file, head.segbits_files));
+	// by far the largest sections, checked one segbits file at a time by
+	// load_segbits.
+	RES_TRY_ASSIGN(result.features =,
+	               cache_section<feature_record>(file, head.features, false));
+	RES_TRY_ASSIGN(result.bits =,
+	               cache_section<bit_record>(file, head.bits, false));
+
+	std::vector<symbol_table::entry> entries;
+	entries.reserve(result.symbols.size());
+	for (const symbol_record &record : result.symbols)
+	{
+		RES_TRY_ASSIGN(const lak::astring_view name =, result.string(record.name));
+		entries.push_back({.name = name, .hash = record.hash});
+	}
+	result.symbol_ids = symbol_table::global().adopt(
+	  lak::span<const symbol_table::entry>(entries.data(), entries.size()));
+
+	return lak::ok_t{lak::move(result)};
+}
+
+lak::result<lak::astring_view> database_cache::string(string_ref ref) const
+{
+	if (ref.offset > strings.size() || ref.size > strings.size() - ref.offset)
+		return lak::err_t{};
+	return lak::ok_t{lak::astring_view(strings.data() + ref.offset,
+	                                   strings.data() + ref.offset + ref.size)};
+}
+
+lak::result<symbol_id> database_cache::symbol(symbol_index index) const
+{
+	if (index >= symbol_ids.size()) return lak::err_t{};
+	return lak::ok_t{symbol_ids[index]};
+}
+
+lak::result<tilegrid> database_cache::load_tilegrid() const
+{
+	tilegrid result;
+	result.reserve(tiles.size());
+
+	for (const tile_record &record : tiles)
+	{
+		RES_TRY_ASSIGN(const symbol_id name =, symbol(record.name));
+		RES_TRY_ASSIGN(const symbol_id type =, symbol(record.type));
+
+		if (record.bus_begin > buses.size() ||
+		    record.bus_count > buses.size() - record.bus_begin)
+			return lak::err_t{};
+
+		const tile_id id =
+		  result.insert(name, type, record.grid_x, record.grid_y);
+
+		for (const bus_record &bus :
+		     buses.subspan(record.bus_begin, record.bus_count))
+		{
+			if (bus.block >= tilegrid::block_type_count) return lak::err_t{};
+			result.set_bus(id,
+			               {
+			                 .block        = frame_address::block_type(bus.block),
+			                 .base_address = bus.base_address,
+			                 .frame_count  = bus.frame_count,
+			                 .word_offset  = bus.word_offset,
+			                 .word_count   = bus.word_count,
+			               });
+		}
+	}
+
+	return lak::ok_t{lak::move(result)};
+}
+
+lak::result<tile_segbits> database_cache::load_segbits(
+  const segbits_record &record) const
+{
+	tile_segbits result;
+
+	if (record.feature_begin > features.size() ||
+	    record.feature_count > features.size() - record.feature_begin ||
+	    record.bit_begin > bits.size() ||
+	    record.bit_count > bits.size() - record.bit_begin)
+		return lak::err_t{};
+
+	const auto file_features =
+	  features.subspan(record.feature_begin, record.feature_count);
+	const auto file_bits = bits.subspan(record.bit_begin, record.bit_count);
+	if (cache_checksum(file_features, file_bits) != record.checksum)
+		return lak::err_t{};
+
+	std::vector<segbit> scratch;
+	for (const feature_record &feature : file_features)
+	{
+		RES_TRY_ASSIGN(const symbol_id name =, symbol(feature.name));
+
+		if (feature.bit_begin < record.bit_begin ||
+		    feature.bit_begin - record.bit_begin > file_bits.size() ||
+		    feature.bit_count >
+		      file_bits.size() - (feature.bit_begin - record.bit_begin))
+			return lak::err_t{};
+
+		scratch.clear();
+		for (const bit_record &bit : file_bits.subspan(
+		       feature.bit_begin - record.bit_begin, feature.bit_count))
+			scratch.push_back(segbit{bit.packed});
+
+		insert_feature(
+		  result, symbol_table::global().name(name), name, lak::span(scratch));
+	}
+
+	return lak::ok_t{lak::move(result)};
+}
+
+/* --- database --- */
+
+static auto open_file(const std::filesystem::path &path)
+{
+	return map_file(path).map_err(
+	  [&](const auto &err) -> lak::monostate
+	  {
+		  user_error("Failed to open ", path, ": ", err);
+		  return {};
+	  });
+}
+
+static lak::result<std::unordered_map<lak::astring, database::segbits_file>>
+index_segbits(const fs::path &family_path)
+{
+	std::unordered_map<lak::astring, database::segbits_file> result;
+
+	std::error_code ec;
+	for (const auto &entry : fs::directory_iterator(family_path, ec))
+	{
+		if (!entry.is_regular_file()) continue;
+		if (lak::astring key = segbits_key(entry.path()); !key.empty())
+			result.insert_or_assign(lak::move(key),
+			                        database::segbits_file{.path = entry.path()});
+	}
+	if (ec)
+	{
+		user_error("Failed to read ", family_path, ": ", ec.message());
+		return lak::err_t{};
+	}
+
+	return lak::ok_t{lak::move(result)};
+}
+
+lak::result<database> database::index(const fs::path &path,
+                                      lak::astring_view family,
+                                      lak::astring_view fabric)
 {
 	database result;
 
 	const auto family_path{path / family.to_string()};
 	const auto fabric_path{family_path / fabric.to_string()};
-	const auto package_path{family_path / package.to_string()};
 
-	auto open_file = [](const std::filesystem::path &path)
+	result.tilegrid_path = fabric_path / "tilegrid.json";
+
+	// the source files are only listed and stat'd, never read.
+	RES_TRY_ASSIGN(result.segbits_files =, index_segbits(family_path));
+
+	RES_TRY_ASSIGN(
+	  result.fingerprint =,
+	  source_fingerprint(result.tilegrid_path, result.segbits_files));
+
+	return lak::ok_t{lak::move(result)};
+}
+
+lak::result<database> database::open(const fs::path &path,
+                                     lak::astring_view family,
+                                     lak::astring_view fabric)
+{
+	RES_TRY_ASSIGN(database result =, index(path, family, fabric));
+	RES_TRY(result.load_tilegrid());
+	return lak::ok_t{lak::move(result)};
+}
+
+lak::result<lak::monostate> database::open_cache(const fs::path &cache_path)
+{
+	RES_TRY_ASSIGN(mapped_file file =,
+	               map_file(cache_path).map_err(
+	                 [](const auto &) -> lak::monostate { return {}; }));
+
+	RES_TRY_ASSIGN(database_cache view =,
+	               database_cache::view(file.data(), fingerprint));
+
+	std::vector<
+	  std::pair<segbits_file *, const database_cache::segbits_record *>>
+	  cached;
+	cached.reserve(view.segbits_files.size());
+	for (const auto &record : view.segbits_files)
+	{
+		RES_TRY_ASSIGN(const lak::astring_view key =, view.string(record.key));
+		auto it = segbits_files.find(key.to_string());
+		// can't happen while the fingerprint matches.
+		if (it == segbits_files.end()) return lak::err_t{};
+		cached.emplace_back(&it->second, &record);
+	}
+
+	// the views into the mapping survive the move.
+	cache_file = lak::move(file);
+	cache      = lak::move(view);
+	for (const auto &[segbits, record] : cached) segbits->cached = record;
+
+	return lak::ok_t{};
+}
+
+lak::result<lak::monostate> database::load_tilegrid()
+{
+	if (cache_file.size() > 0U)
+	{
+		if_let_ok (tilegrid grid, cache.load_tilegrid())
+		{
+			tiles = lak::move(grid);
+			return lak::ok_t{};
+		}
+		user_warning("Database cache tilegrid is corrupt, loading ",
+		             tilegrid_path,
+		             " instead");
+	}
+
+	RES_TRY_ASSIGN(const mapped_file tilegrid_file =, open_file(tilegrid_path));
+
+	tiles = {};
+	tilegrid_handler handler{.tiles = tiles};
+	RES_TRY(json_parser{tilegrid_file.view()}.parse_events(handler).map_err(
+	  [&](const auto &err) -> lak::monostate
+	  {
+		  user_error("Failed to parse ", tilegrid_path, ": ", err);
+		  return {};
+	  }));
+
+	if (!handler.root_object)
+	{
+		user_error("Expected object at the root of ", tilegrid_path);
+		return lak::err_t{};
+	}
+
+	if (handler.failed) return lak::err_t{};
+
+	return lak::ok_t{};
+}
+
+lak::result<lak::monostate> database::write_cache(const fs::path &cache_path,
+                                                  thread_pool &pool)
+{
+	RES_TRY(load_all_segbits(pool));
+
+	std::vector<char> strings;
+	auto add_string = [&](lak::astring_view str)
+	{
+		const database_cache::string_ref result{
+		  .offset = uint32_t(strings.size()),
+		  .size   = uint32_t(str.size()),
+		};
+		strings.insert(strings.end(), str.begin(), str.end());
+		return result;
+	};
+
+	std::vector<database_cache::symbol_record> symbol_records;
+	std::unordered_map<symbol_id, database_cache::symbol_index> symbol_indices;
+	auto add_symbol = [&](symbol_id id)
+	{
+		auto [it, inserted] = symbol_indices.try_emplace(
+		  id, database_cache::symbol_index(symbol_records.size()));
+		if (inserted)
+		{
+			const lak::astring_view name = symbol_table::global().name(id);
+			symbol_records.push_back(
+			  {.name = add_string(name), .hash = symbol_hash(name)});
+		}
+		return it->second;
+	};
+
+	std::vector<database_cache::tile_record> tile_records;
+	std::vector<database_cache::bus_record> bus_records;
+	tile_records.reserve(tiles.size());
+	for (tile_id id = 0U; id < tiles.size(); ++id)
+	{
+		tile_records.push_back({
+		  .name      = add_symbol(tiles.names[id]),
+		  .type      = add_symbol(tiles.types[id]),
+		  .grid_x    = tiles.grid_x[id],
+		  .grid_y    = tiles.grid_y[id],
+		  .bus_begin = uint32_t(bus_records.size()),
+		  .bus_count = uint32_t(std::popcount(tiles.bus_masks[id])),
+		});
+		for (size_t block = 0U; block < tilegrid::block_type_count; ++block)
+			if (const auto bus = tiles.bus(id, frame_address::block_type(block));
+			    bus)
+				bus_records.push_back({
+				  .block        = uint32_t(bus->block),
+				  .base_address = bus->base_address,
+				  .frame_count  = bus->frame_count,
+				  .word_offset  = bus->word_offset,
+				  .word_count   = bus->word_count,
+				});
+	}
+
+	std::vector<database_cache::segbits_record> segbits_records;
+	std::vector<database_cache::feature_record> feature_records;
+	std::vector<database_cache::bit_record> bit_records;
+	for (const auto &[key, file] : segbits_files)
 	{
-		return read_file(path).map_err(
-		  [&](const auto &err) -> lak::monostate
-		  {
-			  user_error("Failed to open ", path, ": ", err);
-			  return {};
+		database_cache::segbits_record &record = segbits_records.emplace_back(
+		  database_cache::segbits_record{
+		    .key = add_string(
+		      lak::astring_view(key.data(), key.data() + key.size())),
+		    .feature_begin = uint32_t(feature_records.size()),
+		    .feature_count = uint32_t(file.segbits.feature_count),
+		    .bit_begin     = uint32_t(bit_records.size()),
 		  });
+		for (const auto &entry : file.segbits.entries)
+		{
+			if (entry.feature == tile_segbits::empty_entry) continue;
+			feature_records.push_back({
+			  .name      = add_symbol(entry.feature),
+			  .bit_begin = uint32_t(bit_records.size()),
+			  .bit_count = entry.end - entry.begin,
+			});
+			for (uint32_t i = entry.begin; i < entry.end; ++i)
+				bit_records.push_back({.packed = file.segbits.bits[i].packed});
+		}
+		record.bit_count = uint32_t(bit_records.size()) - record.bit_begin;
+		record.checksum  = cache_checksum(
+		  lak::span<const database_cache::feature_record>(
+		    feature_records.data() + record.feature_begin, record.feature_count),
+		  lak::span<const database_cache::bit_record>(
+		    bit_records.data() + record.bit_begin, record.bit_count));
+	}
+
+	std::vector<uint8_t> buffer(sizeof(database_cache::header), 0U);
+	auto add_section = [&](const auto &records, bool checked = true)
+	{
+		using T = typename std::remove_cvref_t<decltype(records)>::value_type;
+		buffer.resize((buffer.size() + 7U) & ~size_t(7U), 0U);
+		const database_cache::section result{
+		  .offset   = buffer.size(),
+		  .count    = records.size(),
+		  .checksum = checked ? cache_checksum(lak::span<const T>(
+		                          records.data(), records.size()))
+		                      : 0U,
+		};
+		const uint8_t *data = reinterpret_cast<const uint8_t *>(records.data());
+		buffer.insert(buffer.end(), data, data + (records.size() * sizeof(T)));
+		return result;
 	};
 
-	return lak::ok_t{lak::move(result)};
+	database_cache::header head = {};
+	std::copy(std::begin(database_cache::magic),
+	          std::end(database_cache::magic),
+	          head.magic);
+	head.version       = database_cache::version;
+	head.fingerprint   = fingerprint;
+	head.strings       = add_section(strings);
+	head.symbols       = add_section(symbol_records);
+	head.tiles         = add_section(tile_records);
+	head.buses         = add_section(bus_records);
+	head.segbits_files = add_section(segbits_records);
+	head.features      = add_section(feature_records, false);
+	head.bits          = add_section(bit_records, false);
+	head.file_size     = buffer.size();
+	head.checksum      = cache_checksum(head);
+	std::memcpy(buffer.data(), &head, sizeof(head));
+
+	RES_TRY(write_file(cache_path, lak::span<const uint8_t>(buffer))
+	          .map_err(
+	            [&](const auto &err) -> lak::monostate
+	            {
+		            user_error("Failed to write ", cache_path, ": ", err);
+		            return {};
+	            }));
+
+	return lak::ok_t{};
+}
+
+lak::result<const tile_segbits *> database::segbits(
+  lak::astring_view tile_type, frame_address::block_type block)
+{
+	lak::astring key = tile_type.to_string();
+	switch (block)
+	{
+		case frame_address::block_type::clb_io_clk: break;
+		case frame_address::block_type::block_ram: key += ".BLOCK_RAM"; break;
+		default: return lak::ok_t<const tile_segbits *>{nullptr};
+	}
+
+	auto it = segbits_files.find(key);
+	if (it == segbits_files.end())
+		return lak::ok_t<const tile_segbits *>{nullptr};
+
+	segbits_file &file = it->second;
+	RES_TRY(load_file(file));
+
+	return lak::ok_t<const tile_segbits *>{&file.segbits};
+}
+
+lak::result<const tile_segbits *> database::tile_type_segbits(
+  tile_id tile, frame_address::block_type block)
+{
+	const uint32_t type         = tiles.type_indices[tile];
+	const uint8_t mask          = uint8_t(1U << size_t(block));
+	const tile_segbits *&result = tiles.type_segbits[size_t(block)][type];
+	if ((tiles.type_segbits_set[type] & mask) == 0U)
+	{
+		RES_TRY_ASSIGN(
+		  result =,
+		  segbits(symbol_table::global().name(tiles.type_names[type]), block));
+		tiles.type_segbits_set[type] |= mask;
+	}
+	return lak::ok_t{result};
+}
+
+lak::result<bool> database::resolve_bits(tile_id tile,
+                                         symbol_id feature,
+                                         lak::optional<uint32_t> index,
+                                         const frame_memory &frames,
+                                         frame_edits &edits)
+{
+	bool found = false;
+	for (const auto block : {frame_address::block_type::clb_io_clk,
+	                         frame_address::block_type::block_ram})
+	{
+		const auto bus = tiles.bus(tile, block);
+		if (!bus) continue;
+
+		RES_TRY_ASSIGN(const tile_segbits *tile_bits =,
+		               tile_type_segbits(tile, block));
+		if (!tile_bits) continue;
+
+		if_let_ok (const lak::span<const segbit> bits,
+		           index ? tile_bits->find(feature, *index)
+		                 : tile_bits->find(feature))
+		{
+			found = true;
+			for (const segbit bit : bits)
+			{
+				const uint32_t word = bus->word_offset + bit.word();
+				auto frame = frames.frame_index(bus->base_address + bit.frame());
+				if (frame.is_err() || word >= words_per_frame)
+				{
+					user_error("Bit ",
+					           bit,
+					           " of tile ",
+					           symbol_table::global().name(tiles.names[tile]),
+					           " is outside of the part's frames");
+					return lak::err_t{};
+				}
+				edits.set(frame.unwrap(), word, bit.word_bit(), bit.value());
+			}
+		}
+	}
+
+	return lak::ok_t{found};
+}
+
+lak::result<lak::monostate> database::resolve(
+  const fasm_parser::fasm_feature &feature,
+  const frame_memory &frames,
+  frame_edits &edits)
+{
+	const auto tile = tiles.find(feature.tile_id);
+	if (!tile)
+	{
+		user_error("Unknown tile '", feature.feature.front(), "'");
+		return lak::err_t{};
+	}
+
+	// FEATURE[hi:lo] = value sets FEATURE[lo + i] for each set bit i of value,
+	// FEATURE[n] and FEATURE are a single bit.
+	uintmax_t lo = 0U;
+	uintmax_t hi = 0U;
+	if (feature.address)
+	{
+		hi = feature.address->address1;
+		lo = feature.address->address2 ? *feature.address->address2 : hi;
+	}
+	if (lo > hi)
+	{
+		user_error("Reversed address range in feature ", feature.name);
+		return lak::err_t{};
+	}
+	const uintmax_t width = hi - lo + 1U;
+
+	const fasm_parser::integer one = uintmax_t(1U);
+	const fasm_parser::integer &value =
+	  feature.value ? feature.value->value : one;
+	const uintmax_t *small_value = value.template get<uintmax_t>();
+	const lak::bigint *big_value = value.template get<lak::bigint>();
+
+	const uintmax_t value_bits =
+	  small_value ? uintmax_t(std::bit_width(*small_value))
+	              : big_value->min_bit_count();
+	if (value_bits > width)
+	{
+		user_error("Value is too wide for feature ", feature.name);
+		return lak::err_t{};
+	}
+
+	for (uintmax_t i = 0U; i < value_bits; ++i)
+	{
+		if (small_value ? ((*small_value >> i) & 1U) == 0U
+		                : big_value->bit(i) == 0U)
+			continue;
+
+		// FEATURE[n] is looked up by (FEATURE, n) rather than by name, segbits
+		// never index past 32 bits.
+		const uintmax_t index = lo + i;
+		bool found            = false;
+		if (!feature.address || index <= UINT32_MAX)
+		{
+			RES_TRY_ASSIGN(found =,
+			               resolve_bits(*tile,
+			                            feature.suffix_id,
+			                            feature.address
+			                              ? lak::optional<uint32_t>{uint32_t(index)}
+			                              : lak::optional<uint32_t>{},
+			                            frames,
+			                            edits));
+		}
+
+		if (found) continue;
+		// pseudo pips (ppips_*.db) have no bits and aren't loaded.
+		if (feature.address)
+			user_warning(
+			  "No bits for feature ", feature.name, "[", index, "], skipping");
+		else
+			user_warning("No bits for feature ", feature.name, ", skipping");
+	}
+
+	return lak::ok_t{};
+}
+
+lak::result<lak::monostate> database::clear_tile(
+  symbol_id tile_name,
+  frame_memory &frames,
+  std::vector<uint32_t> &touched) const
+{
+	const auto tile = tiles.find(tile_name);
+	if (!tile)
+	{
+		user_error("Unknown tile '", symbol_table::global().name(tile_name), "'");
+		return lak::err_t{};
+	}
+
+	for (size_t block = 0U; block < tilegrid::block_type_count; ++block)
+	{
+		const auto bus = tiles.bus(*tile, frame_address::block_type(block));
+		if (!bus) continue;
+
+		for (uint32_t minor = 0U; minor < bus->frame_count; ++minor)
+		{
+			auto frame = frames.frame_index(bus->base_address + minor);
+			if (frame.is_err() ||
+			    bus->word_offset + bus->word_count > words_per_frame)
+			{
+				user_error("Tile ",
+				           symbol_table::global().name(tile_name),
+				           " is outside of the part's frames");
+				return lak::err_t{};
+			}
+
+			const size_t index = frame.unwrap();
+			touched.push_back(uint32_t(index));
+			// untouched frames already hold the default (zero) page.
+			if (frames.is_default(index)) continue;
+
+			const lak::span<uint32_t> words = frames.write_frame(index);
+			std::fill_n(
+			  words.begin() + bus->word_offset, bus->word_count, uint32_t(0U));
+		}
+	}
+
+	return lak::ok_t{};
+}
+
+// what a feature sets. a feature without a value sets 1 and FEATURE[n] is
+// FEATURE[n:n], so features setting the same bits compare equal however
+// they're written.
+struct feature_setting
+{
+	symbol_id tile;
+	symbol_id suffix;
+	bool addressed;
+	uintmax_t hi;
+	uintmax_t lo;
+	// nullptr for 1.
+	const fasm_parser::integer *value;
+
+	static feature_setting of(const fasm_parser::fasm_feature &feature)
+	{
+		feature_setting result = {
+		  .tile      = feature.tile_id,
+		  .suffix    = feature.suffix_id,
+		  .addressed = bool(feature.address),
+		  .hi        = 0U,
+		  .lo        = 0U,
+		  .value     = nullptr,
+		};
+		if (feature.address)
+		{
+			result.hi = feature.address->address1;
+			result.lo = feature.address->address2 ? *feature.address->address2
+			                                      : result.hi;
+		}
+		if (feature.value)
+			if (const uintmax_t *small =
+			      feature.value->value.template get<uintmax_t>();
+			    !small || *small != 1U)
+				result.value = &feature.value->value;
+		return result;
+	}
+
+	bool operator==(const feature_setting &rhs) const
+	{
+		if (tile != rhs.tile || suffix != rhs.suffix ||
+		    addressed != rhs.addressed || hi != rhs.hi || lo != rhs.lo)
+			return false;
+		if (!value || !rhs.value) return value == rhs.value;
+		// only values that overflow a uintmax_t are promoted to bigints.
+		const uintmax_t *small     = value->template get<uintmax_t>();
+		const uintmax_t *rhs_small = rhs.value->template get<uintmax_t>();
+		if (small || rhs_small) return small && rhs_small && *small == *rhs_small;
+		return (*value->template get<lak::bigint>() <=>
+		        *rhs.value->template get<lak::bigint>()) == 0;
+	}
+
+	struct hash
+	{
+		size_t operator()(const feature_setting &setting) const
+		{
+			uint64_t result = mix(mix(0x9E3779B97F4A7C15U, setting.tile),
+			                      setting.suffix);
+			result = mix(mix(result, setting.hi), setting.lo);
+			if (!setting.value) return size_t(mix(result, 1U));
+			if (const uintmax_t *small =
+			      setting.value->template get<uintmax_t>();
+			    small)
+				return size_t(mix(result, *small));
+			return size_t(mix(
+			  result,
+			  setting.value->template get<lak::bigint>()->min_bit_count()));
+		}
+	};
+};
+
+lak::result<size_t> database::assemble_changes(
+  lak::span<const fasm_parser::line> base_lines,
+  lak::span<const fasm_parser::line> lines,
+  frame_memory &frames,
+  std::vector<uint32_t> &touched)
+{
+	std::unordered_map<feature_setting, bool, feature_setting::hash>
+	  base_kept;
+	for (const auto &line : base_lines)
+		if (line.feature)
+			base_kept.emplace(feature_setting::of(*line.feature), false);
+
+	std::unordered_set<symbol_id> changed_names;
+	for (const auto &line : lines)
+	{
+		if (!line.feature) continue;
+		if (auto it = base_kept.find(feature_setting::of(*line.feature));
+		    it != base_kept.end())
+			it->second = true;
+		else
+			changed_names.insert(line.feature->tile_id);
+	}
+	for (const auto &[setting, kept] : base_kept)
+		if (!kept) changed_names.insert(setting.tile);
+
+	std::vector<uint8_t> reassembled(tiles.size(), 0U);
+	std::vector<tile_id> pending;
+	for (const symbol_id name : changed_names)
+	{
+		const auto tile = tiles.find(name);
+		if (!tile)
+		{
+			user_error("Unknown tile '", symbol_table::global().name(name), "'");
+			return lak::err_t{};
+		}
+		if (reassembled[*tile]) continue;
+		reassembled[*tile] = 1U;
+		pending.push_back(*tile);
+	}
+
+	// clearing a tile clears every word it spans, and paired tiles (such as a
+	// CLB and its INT tile) span the same words. so every tile sharing words
+	// with a changed tile is reassembled along with it, until no more are
+	// added. tiles only share words with tiles in the same column, so the
+	// tiles are indexed by (block, column).
+	const auto column_key = [](size_t block, uint32_t base_address)
+	{
+		frame_address column = frame_address::decode(base_address);
+		column.minor         = 0U;
+		return (uint64_t(block) << 32U) | column.encode();
+	};
+	std::unordered_map<uint64_t, std::vector<tile_id>> columns;
+	for (tile_id tile = 0U; tile < tiles.size(); ++tile)
+		for (size_t block = 0U; block < tilegrid::block_type_count; ++block)
+			if (tiles.bus_masks[tile] & (1U << block))
+				columns[column_key(block, tiles.buses[block].base_address[tile])]
+				  .push_back(tile);
+
+	for (size_t i = 0U; i < pending.size(); ++i)
+	{
+		const tile_id tile = pending[i];
+		for (size_t block = 0U; block < tilegrid::block_type_count; ++block)
+		{
+			const auto bus = tiles.bus(tile, frame_address::block_type(block));
+			if (!bus) continue;
+
+			const uint32_t frame_end = bus->base_address + bus->frame_count;
+			const uint32_t word_end  = bus->word_offset + bus->word_count;
+
+			const tilegrid::bus_columns &bus_columns = tiles.buses[block];
+			for (const tile_id other :
+			     columns[column_key(block, bus->base_address)])
+			{
+				if (reassembled[other]) continue;
+				if (bus_columns.base_address[other] < frame_end &&
+				    bus->base_address < bus_columns.base_address[other] +
+				                          bus_columns.frame_count[other] &&
+				    bus_columns.word_offset[other] < word_end &&
+				    bus->word_offset <
+				      bus_columns.word_offset[other] + bus_columns.word_count[other])
+				{
+					reassembled[other] = 1U;
+					pending.push_back(other);
+				}
+			}
+		}
+	}
+
+	// the reassembled tiles' words now only hold bits of their own features,
+	// so clearing them and resolving their features again gives the same
+	// frames as assembling everything from scratch.
+	const size_t first_touched = touched.size();
+	for (const tile_id tile : pending)
+		RES_TRY(clear_tile(tiles.names[tile], frames, touched));
+
+	frame_edits edits;
+	for (const auto &line : lines)
+	{
+		if (!line.feature) continue;
+		if (const auto tile = tiles.find(line.feature->tile_id);
+		    tile && reassembled[*tile])
+			RES_TRY(resolve(*line.feature, frames, edits));
+	}
+	edits.apply(frames);
+
+	std::sort(touched.begin() + first_touched, touched.end());
+	touched.erase(std::unique(touched.begin() + first_touched, touched.end()),
+	              touched.end());
+
+	return lak::ok_t{pending.size()};
+}
+
+lak::result<lak::monostate> database::load_file(segbits_file &file)
+{
+	if (file.loaded) return lak::ok_t{};
+
+	// the cache's features and bits are only checked here, a corrupt entry
+	// falls back to the text file.
+	if (file.cached)
+	{
+		if_let_ok (tile_segbits segbits, cache.load_segbits(*file.cached))
+		{
+			file.segbits = lak::move(segbits);
+			file.loaded  = true;
+			return lak::ok_t{};
+		}
+		user_warning("Database cache entry for ",
+		             file.path,
+		             " is corrupt, loading the text file instead");
+		file.cached = nullptr;
+	}
+
+	RES_TRY_ASSIGN(file.segbits =, load_segbits(file.path));
+	file.loaded = true;
+	return lak::ok_t{};
+}
+
+void database::add_segbits_loads(
+  task_graph &graph, std::initializer_list<task_graph::task_id> dependencies)
+{
+	// each task only touches its own segbits_file, symbol_table::global() is
+	// the only shared state.
+	for (auto &entry : segbits_files)
+		if (segbits_file &file = entry.second; !file.loaded)
+			graph.add([&] { return load_file(file); }, dependencies);
+}
+
+lak::result<lak::monostate> database::load_all_segbits(thread_pool &pool)
+{
+	task_graph loads;
+	add_segbits_loads(loads);
+	return loads.run(pool);
+}
+
+void database_test()
+{
+	SCOPED_CHECKPOINT("Database tests");
+
+	symbol_table &symbols = symbol_table::global();
+
+	// two columns of 4 frames.
+	const auto part =
+	  json_parser{
+	    R"({"idcode": 1, "global_clock_regions": {"top": {"rows": {"0": )"
+	    R"({"configuration_buses": {"CLB_IO_CLK": {"configuration_columns": )"
+	    R"({"0": {"frame_count": 4}, "1": {"frame_count": 4}}}}}}}}})"_view}
+	    .parse();
+	ASSERT(part.is_ok());
+	const json_parser::value_type &part_root = part.unwrap().root;
+
+	// like prjxray, each CLB tile spans exactly the same frames and words as
+	// the INT tile next to it. X4Y0 is in the next column, so it shares frames
+	// with none of the others.
+	database db;
+	const struct
+	{
+		lak::astring_view name;
+		lak::astring_view type;
+		uint16_t column;
+		uint32_t word_offset;
+	} test_tiles[] = {
+	  {"INT_L_X2Y0"_view, "INT_L"_view, 0U, 0U},
+	  {"CLBLL_L_X2Y0"_view, "CLBLL_L"_view, 0U, 0U},
+	  {"INT_L_X2Y1"_view, "INT_L"_view, 0U, 2U},
+	  {"CLBLL_L_X2Y1"_view, "CLBLL_L"_view, 0U, 2U},
+	  {"INT_L_X4Y0"_view, "INT_L"_view, 1U, 0U},
+	};
+	for (const auto &test_tile : test_tiles)
+	{
+		const tile_id tile = db.tiles.insert(symbols.intern(test_tile.name),
+		                                     symbols.intern(test_tile.type),
+		                                     0U,
+		                                     0U);
+		db.tiles.set_bus(
+		  tile,
+		  tile_bus{
+		    .block        = frame_address::block_type::clb_io_clk,
+		    .base_address = frame_address{.column = test_tile.column}.encode(),
+		    .frame_count  = 4U,
+		    .word_offset  = test_tile.word_offset,
+		    .word_count   = 2U,
+		  });
+	}
+
+	const auto add_feature = [&](lak::astring_view type,
+	                             lak::astring_view name,
+	                             std::initializer_list<segbit> bits)
+	{
+		database::segbits_file &file = db.segbits_files[type.to_string()];
+		file.loaded                  = true;
+		insert_feature(file.segbits,
+		               name,
+		               symbols.intern(name),
+		               lak::span<const segbit>(bits.begin(), bits.size()));
+	};
+	// A and B share their bits, like the bits of a mux.
+	add_feature("INT_L"_view,
+	            "A"_view,
+	            {segbit::make(0U, 0U, true), segbit::make(0U, 33U, true)});
+	add_feature("INT_L"_view,
+	            "B"_view,
+	            {segbit::make(0U, 0U, true), segbit::make(0U, 33U, false)});
+	add_feature("INT_L"_view, "C"_view, {segbit::make(1U, 5U, true)});
+	add_feature("CLBLL_L"_view, "V[0]"_view, {segbit::make(2U, 0U, true)});
+	add_feature("CLBLL_L"_view, "V[1]"_view, {segbit::make(2U, 1U, true)});
+	add_feature("CLBLL_L"_view, "D"_view, {segbit::make(3U, 40U, true)});
+
+	const auto parse = [](lak::astring_view str)
+	{
+		auto lines = fasm_parser{str}.parse();
+		ASSERT(lines.is_ok());
+		return lines.unwrap();
+	};
+
+	const auto empty_frames = [&]
+	{
+		auto frames = frame_memory::from_part(part_root);
+		ASSERT(frames.is_ok());
+		return frames.unwrap();
+	};
+
+	const auto assemble = [&](const std::vector<fasm_parser::line> &lines)
+	{
+		frame_memory frames = empty_frames();
+		frame_edits edits;
+		for (const auto &line : lines)
+			if (line.feature)
+				ASSERT(db.resolve(*line.feature, frames, edits).is_ok());
+		edits.apply(frames);
+		return frames;
+	};
+
+	const std::vector<fasm_parser::line> base_lines = parse(
+	  "INT_L_X2Y0.A\n"
+	  "INT_L_X2Y0.C\n"
+	  "CLBLL_L_X2Y0.D\n"
+	  "INT_L_X2Y1.C\n"
+	  "CLBLL_L_X2Y1.D\n"
+	  "INT_L_X4Y0.C\n"_view);
+	const std::vector<uint8_t> base_bitstream =
+	  write_bitstream(assemble(base_lines));
+
+	// patches the base bitstream, which must give the same bytes as
+	// assembling lines from scratch.
+	const auto check_patch =
+	  [&](lak::astring_view str, size_t expected_tiles, size_t expected_frames)
+	{
+		const std::vector<fasm_parser::line> lines = parse(str);
+
+		frame_memory frames = empty_frames();
+		auto image          = read_bitstream(lak::span(base_bitstream), frames);
+		ASSERT(image.is_ok());
+
+		std::vector<uint32_t> touched;
+		const auto reassembled = db.assemble_changes(
+		  lak::span(base_lines), lak::span(lines), frames, touched);
+		ASSERT(reassembled.is_ok());
+		ASSERT_EQUAL(reassembled.unwrap(), expected_tiles);
+		ASSERT_EQUAL(touched.size(), expected_frames);
+		ASSERT(patch_bitstream(
+		         image.unwrap(), frames, lak::span<const uint32_t>(touched))
+		         .is_ok());
+
+		ASSERT(image.unwrap().bytes == write_bitstream(assemble(lines)));
+	};
+
+	// only CLBLL_L_X2Y0 changes, clearing it clears INT_L_X2Y0's words too so
+	// that has to be reassembled with it. features written differently but
+	// setting the same bits aren't changes.
+	check_patch(
+	  "INT_L_X2Y0.A\n"
+	  "INT_L_X2Y0.C\n"
+	  "CLBLL_L_X2Y0.V[1:0] = 2'b11\n"
+	  "INT_L_X2Y1.C = 1\n"
+	  "CLBLL_L_X2Y1.D = 1'b1\n"
+	  "INT_L_X4Y0.C\n"_view,
+	  2U,
+	  4U);
+
+	// the mux in INT_L_X2Y0 switches from A to B.
+	check_patch(
+	  "INT_L_X2Y0.B\n"
+	  "INT_L_X2Y0.C\n"
+	  "CLBLL_L_X2Y0.D\n"
+	  "INT_L_X2Y1.C\n"
+	  "CLBLL_L_X2Y1.D\n"
+	  "INT_L_X4Y0.C\n"_view,
+	  2U,
+	  4U);
+
+	// both pairs of column 0 and the tile in column 1 change.
+	check_patch(
+	  "INT_L_X2Y0.C\n"
+	  "CLBLL_L_X2Y1.V[1] = 1\n"
+	  "INT_L_X4Y0.A\n"_view,
+	  5U,
+	  8U);
+
+	// nothing changes.
+	check_patch(
+	  "INT_L_X4Y0.C\n"
+	  "CLBLL_L_X2Y1.D\n"
+	  "INT_L_X2Y1.C\n"
+	  "CLBLL_L_X2Y0.D\n"
+	  "INT_L_X2Y0.C = 1'h1\n"
+	  "INT_L_X2Y0.A\n"_view,
+	  0U,
+	  0U);
+
+	// the streaming tilegrid loader must build the same tilegrid as walking
+	// the parsed tree, key order, unknown keys, nested arrays and all.
+	{
+		const lak::astring_view tilegrid_json =
+		  R"({"CLBLL_L_X2Y1": {"type": "CLBLL_L", "grid_x": 5, "grid_y": "7",)"
+		  R"( "sites": {"SLICE_X0Y1": "SLICEL"}, "bits": {"CLB_IO_CLK":)"
+		  R"( {"baseaddr": "0x00400100", "frames": 36, "offset": 2,)"
+		  R"( "words": 2}}},)"
+		  "\r\n"
+		  R"("INT_L_X2Y1": {"grid_y": 7, "type": "INT_L", "bits":)"
+		  R"( {"CLB_IO_CLK": {"words": "2", "offset": 2, "frames": 28,)"
+		  R"( "alias": {"sites": ["a", "b"]}, "baseaddr": "0x00400000"},)"
+		  R"( "BLOCK_RAM": {"baseaddr": "0x00800100", "frames": 128,)"
+		  R"( "offset": 10, "words": 10}}},)"
+		  "\n"
+		  R"("NULL_X0Y0": {"type": "NULL", "bits": {}}, "ARRAY": [1, {"a": 2}],)"
+		  R"("HCLK_X1Y0": {"type": "HCLK", "grid_x": 1,)"
+		  R"( "extra": [{"type": "nested"}, 3]}})"_view;
+
+		tilegrid from_events;
+		tilegrid_handler handler{.tiles = from_events};
+		ASSERT(json_parser{tilegrid_json}.parse_events(handler).is_ok());
+		ASSERT(handler.root_object);
+		ASSERT(!handler.failed);
+
+		// numbers may be written as literals or strings, missing
+		// coordinates are 0.
+		const auto get_uint = [](const json_parser::object &obj,
+		                         lak::astring_view key,
+		                         int base = 10) -> uint32_t
+		{
+			const json_parser::value_type *value = obj.find(key);
+			if (!value) return 0U;
+			const lak::astring_view *str = value->lit();
+			if (!str) str = value->str();
+			ASSERT(str);
+			return parse_uint(*str, base).unwrap();
+		};
+
+		const auto doc = json_parser{tilegrid_json}.parse();
+		ASSERT(doc.is_ok());
+		tilegrid from_tree;
+		for (const auto &kv : doc.unwrap().root.obj()->key_values)
+		{
+			const json_parser::object *tile_obj = kv.value.obj();
+			if (!tile_obj) continue;
+			const lak::astring_view *type = tile_obj->find("type"_view)->str();
+			ASSERT(type);
+			const tile_id tile =
+			  from_tree.insert(symbols.intern(kv.key.value),
+			                   symbols.intern(*type),
+			                   get_uint(*tile_obj, "grid_x"_view),
+			                   get_uint(*tile_obj, "grid_y"_view));
+			const json_parser::value_type *bits = tile_obj->find("bits"_view);
+			if (!bits) continue;
+			for (const auto &bus : bits->obj()->key_values)
+				from_tree.set_bus(
+				  tile,
+				  tile_bus{
+				    .block =
+				      frame_address::parse_block_type(bus.key.value).unwrap(),
+				    .base_address =
+				      get_uint(*bus.value.obj(), "baseaddr"_view, 16),
+				    .frame_count = get_uint(*bus.value.obj(), "frames"_view),
+				    .word_offset = get_uint(*bus.value.obj(), "offset"_view),
+				    .word_count  = get_uint(*bus.value.obj(), "words"_view),
+				  });
+		}
+
+		ASSERT_EQUAL(from_events.size(), 4U);
+		ASSERT_EQUAL(from_events.size(), from_tree.size());
+		ASSERT(from_events.names == from_tree.names);
+		ASSERT(from_events.types == from_tree.types);
+		ASSERT(from_events.type_indices == from_tree.type_indices);
+		ASSERT(from_events.grid_x == from_tree.grid_x);
+		ASSERT(from_events.grid_y == from_tree.grid_y);
+		ASSERT(from_events.bus_masks == from_tree.bus_masks);
+		for (size_t block = 0U; block < tilegrid::block_type_count; ++block)
+		{
+			const auto &events_bus = from_events.buses[block];
+			const auto &tree_bus   = from_tree.buses[block];
+			ASSERT(events_bus.base_address == tree_bus.base_address);
+			ASSERT(events_bus.frame_count == tree_bus.frame_count);
+			ASSERT(events_bus.word_offset == tree_bus.word_offset);
+			ASSERT(events_bus.word_count == tree_bus.word_count);
+		}
+
+		const auto int_l_tile = from_events.find("INT_L_X2Y1"_view);
+		ASSERT(int_l_tile);
+		const tile_id int_l = *int_l_tile;
+		ASSERT_EQUAL(from_events.grid_x[int_l], 0U);
+		ASSERT_EQUAL(from_events.grid_y[int_l], 7U);
+		const auto bram =
+		  from_events.bus(int_l, frame_address::block_type::block_ram);
+		ASSERT(bram);
+		ASSERT_EQUAL(bram->base_address, 0x00800100U);
+		ASSERT_EQUAL(bram->word_count, 10U);
+		ASSERT_EQUAL(
+		  from_events.bus(int_l, frame_address::block_type::clb_io_clk)
+		    ->frame_count,
+		  28U);
+		ASSERT(!from_events.find("ARRAY"_view));
+
+		// a tile without a type fails the load.
+		tilegrid untyped;
+		tilegrid_handler untyped_handler{.tiles = untyped};
+		ASSERT(json_parser{R"({"A": {"grid_x": 1}})"_view}
+		         .parse_events(untyped_handler)
+		         .is_ok());
+		ASSERT(untyped_handler.failed);
+	}
+
+	DEBUG(LAK_GREEN "Database tests complete" LAK_SGR_RESET);
 }
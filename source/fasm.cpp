@@ -2,39 +2,53 @@
 
 #include "lak/string_literals.hpp"
 
-fasm_parser::result<lak::astring_view>
-fasm_parser::parse_non_newline_whitespace()
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <sstream>
+#include <string>
+
+template<unsigned BASE>
+static void push_digit(fasm_parser::integer &value, unsigned digit)
 {
-	const char *begin = input.begin();
+	if (uintmax_t *small = value.template get<uintmax_t>(); small)
+	{
+		if (*small <= (UINTMAX_MAX - digit) / BASE)
+		{
+			*small = (*small * BASE) + digit;
+			return;
+		}
+		value = lak::bigint(*small);
+	}
 
-	while (pop_char({' ', '\t'}).is_ok())
-		;
+	lak::bigint &big = *value.template get<lak::bigint>();
+	if constexpr (std::has_single_bit(BASE))
+		big <<= uintmax_t(std::countr_zero(BASE));
+	else
+		big *= uintmax_t(BASE);
+	big += uintmax_t(digit);
+}
 
-	return lak::ok_t{lak::astring_view(begin, input.begin())};
+fasm_parser::result<uintmax_t> fasm_parser::to_uintmax(const integer &value)
+{
+	if (const uintmax_t *small = value.template get<uintmax_t>(); small)
+		return lak::ok_t{*small};
+	return value.template get<lak::bigint>()->to_uintmax().map_err(
+	  [](auto &&) { return error_type::integer_overflow; });
+}
+
+fasm_parser::result<lak::astring_view>
+fasm_parser::parse_non_newline_whitespace()
+{
+	return lak::ok_t{skip_while<char_classes::blank>()};
 }
 
 fasm_parser::result<lak::astring_view> fasm_parser::parse_identifier()
 {
 	const char *begin = input.begin();
 
-	RES_TRY_ASSIGN(char c =, peek());
-	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
-	    (c >= '0' && c <= '9'))
-	{
-		for (pop().unwrap();; pop().unwrap())
-		{
-			if_let_ok (c = char, peek())
-			{
-				if (!(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z') &&
-				    !(c >= '0' && c <= '9') && c != '_')
-					break;
-			}
-			else
-				break;
-		}
-	}
-	else
-		return lak::err_t{error_type::unexpected_character};
+	RES_TRY(pop_char<char_classes::alnum>());
+	skip_while<char_classes::identifier>();
 
 	return lak::ok_t{lak::astring_view(begin, input.begin())};
 }
@@ -48,165 +62,51 @@ fasm_parser::parse_feature()
 	{
 		RES_TRY_ASSIGN(const lak::astring_view ident =, parse_identifier());
 		result.push_back(ident);
-	} while (pop_char({'.'}).is_ok());
+	} while (pop_char<char_classes::one_of<'.'>>().is_ok());
 
 	return lak::ok_t{lak::move(result)};
 }
 
-fasm_parser::result<lak::bigint> fasm_parser::parse_dec_value()
+template<unsigned BASE, const char_class &DIGITS>
+static fasm_parser::result<fasm_parser::integer> parse_digits(
+  fasm_parser &parser)
 {
-	lak::bigint result = 0;
-
-	RES_TRY_ASSIGN(char c =, peek());
-	if ((c >= '0' && c <= '9') || c == '_')
-	{
-		if (c != '_')
-		{
-			result *= 10;
-			result += c - '0';
-		}
-		for (pop().unwrap();; pop().unwrap())
-		{
-			if_let_ok (c = char, peek())
-			{
-				if (!(c >= '0' && c <= '9') && c != '_') break;
-				if (c != '_')
-				{
-					result *= 10;
-					result += (c - '0');
-				}
-			}
-			else
-				break;
-		}
-	}
-	else
-		return lak::err_t{error_type::unexpected_character};
+	static constexpr char_class digits_or_separator =
+	  DIGITS | char_class::of("_");
 
-	return lak::ok_t{result};
-}
+	fasm_parser::integer result = uintmax_t(0U);
 
-fasm_parser::result<lak::bigint> fasm_parser::parse_hex_value()
-{
-	lak::bigint result = 0;
+	const lak::astring_view digits =
+	  parser.skip_while<digits_or_separator>();
+	if (digits.empty())
+		return lak::err_t{parser.input.empty()
+		                    ? fasm_parser::error_type::end_of_file
+		                    : fasm_parser::error_type::unexpected_character};
 
-	RES_TRY_ASSIGN(char c =, peek());
-	if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F') ||
-	    (c >= '0' && c <= '9') || c == '_')
-	{
-		if (c >= 'a' && c <= 'f')
-		{
-			result <<= 4U;
-			result += uintmax_t(0xA + (c - 'a'));
-		}
-		else if (c >= 'A' && c <= 'F')
-		{
-			result <<= 4U;
-			result += uintmax_t(0xA + (c - 'A'));
-		}
-		else if (c != '_')
-		{
-			result <<= 4U;
-			result += uintmax_t(c - '0');
-		}
+	for (const char c : digits)
+		if (c != '_') push_digit<BASE>(result, digit_value(c));
 
-		for (pop().unwrap();; pop().unwrap())
-		{
-			if_let_ok (c = char, peek())
-			{
-				if (!(c >= 'a' && c <= 'f') && !(c >= 'A' && c <= 'F') &&
-				    !(c >= '0' && c <= '9') && c != '_')
-					break;
-				if (c >= 'a' && c <= 'f')
-				{
-					result <<= 4U;
-					result += uintmax_t(0xA + (c - 'a'));
-				}
-				else if (c >= 'A' && c <= 'F')
-				{
-					result <<= 4U;
-					result += uintmax_t(0xA + (c - 'A'));
-				}
-				else if (c != '_')
-				{
-					result <<= 4U;
-					result += uintmax_t(c - '0');
-				}
-			}
-			else
-				break;
-		}
-	}
-	else
-		return lak::err_t{error_type::unexpected_character};
-
-	return lak::ok_t{result};
+	return lak::ok_t{lak::move(result)};
 }
 
-fasm_parser::result<lak::bigint> fasm_parser::parse_oct_value()
+fasm_parser::result<fasm_parser::integer> fasm_parser::parse_dec_value()
 {
-	lak::bigint result = 0;
-
-	RES_TRY_ASSIGN(char c =, peek());
-	if ((c >= '0' && c <= '7') || c == '_')
-	{
-		if (c != '_')
-		{
-			result <<= 3U;
-			result += uintmax_t(c - '0');
-		}
-		for (pop().unwrap();; pop().unwrap())
-		{
-			if_let_ok (c = char, peek())
-			{
-				if (!(c >= '0' && c <= '7') && c != '_') break;
-				if (c != '_')
-				{
-					result <<= 3U;
-					result += uintmax_t(c - '0');
-				}
-			}
-			else
-				break;
-		}
-	}
-	else
-		return lak::err_t{error_type::unexpected_character};
-
-	return lak::ok_t{result};
+	return parse_digits<10, char_classes::dec_digit>(*this);
 }
 
-fasm_parser::result<lak::bigint> fasm_parser::parse_bin_value()
+fasm_parser::result<fasm_parser::integer> fasm_parser::parse_hex_value()
 {
-	lak::bigint result = 0;
+	return parse_digits<16, char_classes::hex_digit>(*this);
+}
 
-	RES_TRY_ASSIGN(char c =, peek());
-	if ((c >= '0' && c <= '1') || c == '_')
-	{
-		if (c != '_')
-		{
-			result <<= 1U;
-			result += uintmax_t(c - '0');
-		}
-		for (pop().unwrap();; pop().unwrap())
-		{
-			if_let_ok (c = char, peek())
-			{
-				if (!(c >= '0' && c <= '1') && c != '_') break;
-				if (c != '_')
-				{
-					result <<= 1U;
-					result += uintmax_t(c - '0');
-				}
-			}
-			else
-				break;
-		}
-	}
-	else
-		return lak::err_t{error_type::unexpected_character};
+fasm_parser::result<fasm_parser::integer> fasm_parser::parse_oct_value()
+{
+	return parse_digits<8, char_classes::oct_digit>(*this);
+}
 
-	return lak::ok_t{result};
+fasm_parser::result<fasm_parser::integer> fasm_parser::parse_bin_value()
+{
+	return parse_digits<2, char_classes::bin_digit>(*this);
 }
 
 fasm_parser::result<uint8_t> fasm_parser::parse_value_base()
@@ -239,46 +139,46 @@ fasm_parser::result<uintmax_t> fasm_parser::parse_verilog_value_width()
 		if (begin) input = lak::astring_view(begin, input.end());
 	});
 
-	uintmax_t result;
+	integer value;
 
 	if_let_ok (const uint8_t base, parse_value_base())
 	{
-		lak::result<uintmax_t> value = lak::err_t{};
 		switch (base)
 		{
 			case 2:
 			{
-				RES_TRY_ASSIGN(value =, parse_bin_value()).to_uintmax();
+				RES_TRY_ASSIGN(value =, parse_bin_value());
 			}
 			break;
 			case 8:
 			{
-				RES_TRY_ASSIGN(value =, parse_oct_value()).to_uintmax();
+				RES_TRY_ASSIGN(value =, parse_oct_value());
 			}
 			break;
 			case 10:
 			{
-				RES_TRY_ASSIGN(value =, parse_dec_value()).to_uintmax();
+				RES_TRY_ASSIGN(value =, parse_dec_value());
 			}
 			break;
 			case 16:
 			{
-				RES_TRY_ASSIGN(value =, parse_hex_value()).to_uintmax();
+				RES_TRY_ASSIGN(value =, parse_hex_value());
 			}
 			break;
 			default: ASSERT_UNREACHABLE();
 		}
-		RES_TRY_ASSIGN(
-		  result =,
-		  value.map_err([](auto &&) { return error_type::integer_overflow; }));
 	}
+	else
+		// unsized, e.g. 'hFF.
+		return lak::err_t{error_type::unexpected_character};
 
 	RES_TRY(parse_non_newline_whitespace());
 
-	RES_TRY(peek_char({'\''}));
+	RES_TRY(peek_char<char_classes::one_of<'\''>>());
 
+	// only a width once the quote follows it, a large unsized value is fine.
 	begin = nullptr;
-	return lak::ok_t{result};
+	return to_uintmax(value);
 }
 
 fasm_parser::result<fasm_parser::verilog_value>
@@ -286,16 +186,17 @@ fasm_parser::parse_verilog_value()
 {
 	verilog_value result;
 
-	if_let_ok (const uintmax_t width, parse_verilog_value_width())
-	{
-		result.width = width;
-	}
+	if (auto width = parse_verilog_value_width(); width.is_ok())
+		result.width = width.unwrap();
+	else if (width.unwrap_err() == error_type::integer_overflow)
+		return lak::err_t{error_type::integer_overflow};
 	else
 		RES_TRY(parse_non_newline_whitespace());
 
-	if (pop_char({'\''}).is_ok())
+	if (pop_char<char_classes::one_of<'\''>>().is_ok())
 	{
-		RES_TRY_ASSIGN(const char base =, pop_char({'b', 'o', 'd', 'h'}));
+		RES_TRY_ASSIGN(const char base =,
+		               pop_char<char_classes::one_of<'b', 'o', 'd', 'h'>>());
 		RES_TRY(parse_non_newline_whitespace());
 		switch (base)
 		{
@@ -334,28 +235,17 @@ fasm_parser::parse_feature_address()
 {
 	feature_address result;
 
-	RES_TRY(pop_char({'['}));
+	RES_TRY(pop_char<char_classes::one_of<'['>>());
 
-	RES_TRY_ASSIGN(result.address1 =,
-	               parse_dec_value().and_then(
-	                 [](const lak::bigint &i)
-	                 {
-		                 return i.to_uintmax().map_err(
-		                   [](auto &&) { return error_type::integer_overflow; });
-	                 }));
+	RES_TRY_ASSIGN(result.address1 =, parse_dec_value().and_then(to_uintmax));
 
-	if (pop_char({':'}).is_ok())
+	if (pop_char<char_classes::one_of<':'>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.address2 =,
-		               parse_dec_value().and_then(
-		                 [](const lak::bigint &i)
-		                 {
-			                 return i.to_uintmax().map_err(
-			                   [](auto &&) { return error_type::integer_overflow; });
-		                 }));
+		               parse_dec_value().and_then(to_uintmax));
 	}
 
-	RES_TRY(pop_char({']'}));
+	RES_TRY(pop_char<char_classes::one_of<']'>>());
 
 	return lak::ok_t{result};
 }
@@ -364,36 +254,22 @@ fasm_parser::result<lak::astring_view> fasm_parser::parse_comment()
 {
 	const char *begin = input.begin();
 
-	RES_TRY(pop_char({'#'}));
+	RES_TRY(pop_char<char_classes::one_of<'#'>>());
 
-	while (pop_not_char({'\n', '\r'}).is_ok())
-		;
+	skip_until<char_classes::newline>();
 
 	return lak::ok_t{lak::astring_view(begin, input.begin())};
 }
 
 fasm_parser::result<lak::astring_view> fasm_parser::parse_annotation_name()
 {
+	static constexpr char_class annotation_name_start =
+	  char_classes::alnum | char_class::of(".");
+
 	const char *begin = input.begin();
 
-	RES_TRY_ASSIGN(char c =, peek());
-	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
-	    (c >= '0' && c <= '9') || c == '.')
-	{
-		for (pop().unwrap();; pop().unwrap())
-		{
-			if_let_ok (c = char, peek())
-			{
-				if (!(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z') &&
-				    !(c >= '0' && c <= '9') && c != '_')
-					break;
-			}
-			else
-				break;
-		}
-	}
-	else
-		return lak::err_t{error_type::unexpected_character};
+	RES_TRY(pop_char<annotation_name_start>());
+	skip_while<char_classes::identifier>();
 
 	return lak::ok_t{lak::astring_view(begin, input.begin())};
 }
@@ -402,8 +278,9 @@ fasm_parser::result<lak::astring_view> fasm_parser::parse_annotation_value()
 {
 	const char *begin = input.begin();
 
-	while (pop_not_char({'\\', '"'}).is_ok() || pop_string("\\\""_view).is_ok())
-		;
+	do
+		skip_until<char_classes::string_delimiter>();
+	while (pop_string("\\\""_view).is_ok());
 
 	return lak::ok_t{lak::astring_view(begin, input.begin())};
 }
@@ -416,15 +293,15 @@ fasm_parser::result<fasm_parser::annotation> fasm_parser::parse_annotation()
 
 	RES_TRY(parse_non_newline_whitespace());
 
-	RES_TRY(pop_char({'='}));
+	RES_TRY(pop_char<char_classes::one_of<'='>>());
 
 	RES_TRY(parse_non_newline_whitespace());
 
-	RES_TRY(pop_char({'"'}));
+	RES_TRY(pop_char<char_classes::one_of<'"'>>());
 
 	RES_TRY_ASSIGN(result.value =, parse_annotation_value());
 
-	RES_TRY(pop_char({'"'}));
+	RES_TRY(pop_char<char_classes::one_of<'"'>>());
 
 	return lak::ok_t{result};
 }
@@ -434,7 +311,7 @@ fasm_parser::parse_annotations()
 {
 	std::vector<annotation> result;
 
-	RES_TRY(pop_char({'{'}));
+	RES_TRY(pop_char<char_classes::one_of<'{'>>());
 
 	do
 	{
@@ -442,11 +319,11 @@ fasm_parser::parse_annotations()
 
 		result.emplace_back();
 		RES_TRY_ASSIGN(result.back() =, parse_annotation());
-	} while (pop_char({','}).is_ok());
+	} while (pop_char<char_classes::one_of<','>>().is_ok());
 
 	RES_TRY(parse_non_newline_whitespace());
 
-	RES_TRY(pop_char({'}'}));
+	RES_TRY(pop_char<char_classes::one_of<'}'>>());
 
 	return lak::ok_t{lak::move(result)};
 }
@@ -457,14 +334,24 @@ fasm_parser::result<fasm_parser::fasm_feature> fasm_parser::parse_set_feature()
 
 	RES_TRY_ASSIGN(result.feature =, parse_feature());
 
-	if (peek_char({'['}).is_ok())
+	// the segments are contiguous in the input.
+	result.name = lak::astring_view(result.feature.front().begin(),
+	                                result.feature.back().end());
+
+	result.tile_id   = symbols.intern(result.feature.front());
+	result.suffix_id = symbols.intern(lak::astring_view(
+	  result.feature.size() > 1U ? result.feature[1].begin()
+	                             : result.feature.back().end(),
+	  result.feature.back().end()));
+
+	if (peek_char<char_classes::one_of<'['>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.address =, parse_feature_address());
 	}
 
 	RES_TRY(parse_non_newline_whitespace());
 
-	if (pop_char({'='}).is_ok())
+	if (pop_char<char_classes::one_of<'='>>().is_ok())
 	{
 		RES_TRY(parse_non_newline_whitespace());
 
@@ -480,19 +367,19 @@ fasm_parser::result<fasm_parser::line> fasm_parser::parse_line()
 
 	RES_TRY(parse_non_newline_whitespace());
 
-	if (peek_not_char({'{', '#', '\n', '\r'}).is_ok())
+	if (peek_not_char<char_classes::one_of<'{', '#', '\n', '\r'>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.feature =, parse_set_feature());
 		RES_TRY(parse_non_newline_whitespace());
 	}
 
-	if (peek_char({'{'}).is_ok())
+	if (peek_char<char_classes::one_of<'{'>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.annotations =, parse_annotations());
 		RES_TRY(parse_non_newline_whitespace());
 	}
 
-	if (peek_char({'#'}).is_ok())
+	if (peek_char<char_classes::one_of<'#'>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.comment =, parse_comment());
 		RES_TRY(parse_non_newline_whitespace());
@@ -501,42 +388,152 @@ fasm_parser::result<fasm_parser::line> fasm_parser::parse_line()
 	return lak::ok_t{lak::move(result)};
 }
 
+fasm_parser::result<lak::optional<fasm_parser::line>>
+fasm_parser::parse_next_line()
+{
+	if (input.empty()) return lak::ok_t<lak::optional<line>>{};
+
+	RES_TRY_ASSIGN(line result =, parse_line());
+
+	if_let_ok (const char c, peek_not_char<char_classes::newline>())
+		return lak::err_t{error_type::unexpected_character};
+
+	skip_while<char_classes::newline>();
+
+	return lak::ok_t<lak::optional<line>>{lak::move(result)};
+}
+
 fasm_parser::result<std::vector<fasm_parser::line>> fasm_parser::parse()
 {
 	std::vector<line> result;
 
-	while (!input.empty())
+	RES_TRY(parse([&](line &&l) { result.push_back(lak::move(l)); }));
+
+	return lak::ok_t{lak::move(result)};
+}
+
+fasm_parser::line_error fasm_parser::make_line_error(lak::astring_view file,
+                                                     const char *position,
+                                                     error_type error)
+{
+	return {
+	  .error       = error,
+	  .line_number = size_t(std::count(file.begin(), position, '\n')) + 1U,
+	};
+}
+
+lak::result<std::vector<fasm_parser::line>, fasm_parser::line_error>
+fasm_parser::parse_parallel(thread_pool &pool, size_t min_chunk_size)
+{
+	const lak::astring_view file = input;
+
+	min_chunk_size           = std::max<size_t>(min_chunk_size, 1U);
+	const size_t chunk_count =
+	  std::min(pool.job_count(), (file.size() / min_chunk_size) + 1U);
+
+	if (chunk_count <= 1U)
 	{
-		RES_TRY(lak::move(parse_line())
-		          .map(
-		            [&](auto &&line)
-		            {
-			            result.push_back(lak::move(line));
-			            return lak::monostate{};
-		            }));
-
-		if_let_ok (const char c, peek_not_char({'\n', '\r'}))
-			return lak::err_t{error_type::unexpected_character};
+		return parse().map_err(
+		  [&](error_type err)
+		  { return make_line_error(file, input.begin(), err); });
+	}
+
+	// FASM has no state that crosses a newline, so each chunk can be parsed
+	// independently as long as it starts at the beginning of a line.
+	std::vector<lak::astring_view> chunks;
+	chunks.reserve(chunk_count);
+	for (const char *begin = file.begin(); begin != file.end();)
+	{
+		const size_t remaining = chunk_count - chunks.size();
+		const char *end =
+		  remaining <= 1U ? file.end()
+		                  : begin + (size_t(file.end() - begin) / remaining);
+		end = std::find(end, file.end(), '\n');
+		// blank lines are folded into the previous line by parse_next_line.
+		while (end != file.end() && (*end == '\n' || *end == '\r')) ++end;
+		chunks.emplace_back(begin, end);
+		begin = end;
+	}
+
+	struct chunk_result
+	{
+		std::vector<line> lines;
+		const char *error_position = nullptr;
+		error_type error;
+	};
+	std::vector<chunk_result> results(chunks.size());
+
+	std::atomic<size_t> finished = 0U;
+	for (size_t i = 0U; i < chunks.size(); ++i)
+	{
+		pool.submit(
+		  [&, i]
+		  {
+			  chunk_result &result = results[i];
+			  fasm_parser parser{chunks[i]};
+			  if_let_err (const error_type err,
+			              parser.parse([&](line &&l)
+			                           { result.lines.push_back(lak::move(l)); }))
+			  {
+				  result.error          = err;
+				  result.error_position = parser.input.begin();
+			  }
+			  finished.fetch_add(1U, std::memory_order_release);
+		  });
+	}
+	pool.wait_until(
+	  [&]
+	  { return finished.load(std::memory_order_acquire) == chunks.size(); });
 
-		while (pop_char({'\n', '\r'}).is_ok())
-			;
+	size_t line_count = 0U;
+	for (const auto &result : results)
+	{
+		if (result.error_position)
+			return lak::err_t{
+			  make_line_error(file, result.error_position, result.error)};
+		line_count += result.lines.size();
 	}
 
+	std::vector<line> result;
+	result.reserve(line_count);
+	for (auto &chunk : results)
+		std::move(chunk.lines.begin(),
+		          chunk.lines.end(),
+		          std::back_inserter(result));
+
+	input = input.substr(input.size());
+
 	return lak::ok_t{lak::move(result)};
 }
 
+std::ostream &operator<<(std::ostream &strm,
+                         const fasm_parser::integer &value)
+{
+	// both alternatives respect the stream's basefield.
+	lak::visit(value, [&](const auto &v) { strm << v; });
+	return strm;
+}
+
 std::ostream &operator<<(std::ostream &strm,
                          const fasm_parser::verilog_value &value)
 {
-	if (value.width) strm << std::dec << *value.width << "'";
-	return strm << value.value;
+	// canonical form is sized hex, unsized values stay decimal.
+	const std::ios_base::fmtflags flags = strm.flags();
+	if (value.width)
+		strm << std::dec << *value.width << "'h" << std::hex << value.value;
+	else
+		strm << std::dec << value.value;
+	strm.flags(flags);
+	return strm;
 }
 
 std::ostream &operator<<(std::ostream &strm,
                          const fasm_parser::feature_address &value)
 {
+	const std::ios_base::fmtflags flags = strm.flags();
 	strm << std::dec << "[" << value.address1;
 	if (value.address2) strm << ":" << *value.address2;
+	strm.flags(flags);
 	return strm << "]";
 }
 
@@ -583,7 +580,298 @@ std::ostream &operator<<(std::ostream &strm, const fasm_parser::line &value)
 	return strm << value.comment;
 }
 
+std::ostream &operator<<(std::ostream &strm,
+                         const fasm_parser::line_error &value)
+{
+	const std::ios_base::fmtflags flags = strm.flags();
+	strm << std::dec << "line " << value.line_number;
+	strm.flags(flags);
+	return strm << ": " << value.error;
+}
+
 void fasm_test()
 {
+	SCOPED_CHECKPOINT("FASM tests");
+
+	{
+		// printing leaves the caller's basefield alone.
+		std::ostringstream strm;
+		strm << std::hex;
+		strm << fasm_parser::verilog_value{.width = lak::optional<uintmax_t>{8U},
+		                                   .value = uintmax_t(255U)}
+		     << " " << 255U << " "
+		     << fasm_parser::feature_address{.address1 = 16U} << " " << 16U;
+		ASSERT_EQUAL(strm.str(), "8'hff ff [16] 10");
+	}
+
+	const auto parse_line = [](lak::astring_view str)
+	{ return fasm_parser{str}.parse_line(); };
+
+	const auto view = [](const lak::astring &str)
+	{ return lak::astring_view(str.data(), str.data() + str.size()); };
+
+	using error_type = fasm_parser::error_type;
+
+	{
+		const auto line =
+		  parse_line("CLBLL_L_X2Y1.SLICEL_X0.A5FF_ZINI[3]"_view).unwrap();
+		ASSERT(line.feature);
+		const auto &feature = *line.feature;
+		ASSERT_EQUAL(feature.feature.size(), 3U);
+		ASSERT_EQUAL(feature.feature[0], "CLBLL_L_X2Y1"_view);
+		ASSERT_EQUAL(feature.feature[1], "SLICEL_X0"_view);
+		ASSERT_EQUAL(feature.feature[2], "A5FF_ZINI"_view);
+		ASSERT_EQUAL(feature.name, "CLBLL_L_X2Y1.SLICEL_X0.A5FF_ZINI"_view);
+		ASSERT_EQUAL(symbol_table::global().name(feature.tile_id),
+		             "CLBLL_L_X2Y1"_view);
+		ASSERT_EQUAL(symbol_table::global().name(feature.suffix_id),
+		             "SLICEL_X0.A5FF_ZINI"_view);
+		ASSERT(feature.address);
+		ASSERT_EQUAL(feature.address->address1, 3U);
+		ASSERT(!feature.address->address2);
+		ASSERT(!feature.value);
+
+		// identifiers start with a letter or digit.
+		ASSERT_EQUAL(parse_line("_TILE.FEATURE"_view).unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line("TILE._FEATURE"_view).unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line("TILE..FEATURE"_view).unwrap_err(),
+		             error_type::unexpected_character);
+	}
+
+	{
+		// identifiers either side of the 16 and 32 byte blocks.
+		const lak::astring_view chars = "aZ9_"_view;
+		for (size_t length = 1U; length < 70U; ++length)
+		{
+			lak::astring ident = "T";
+			for (size_t i = 1U; i < length; ++i) ident += chars[i % chars.size()];
+			const lak::astring str = ident + "." + ident + " = 1";
+			const auto line        = parse_line(view(str)).unwrap();
+			ASSERT_EQUAL(line.feature->feature.size(), 2U);
+			ASSERT_EQUAL(line.feature->feature[0], view(ident));
+			ASSERT_EQUAL(line.feature->feature[1], view(ident));
+		}
+	}
+
+	{
+		// more names than the parser's symbol cache holds, so entries are
+		// evicted and interned again. the ids must still be the table's.
+		lak::astring input;
+		for (size_t pass = 0U; pass < 2U; ++pass)
+			for (size_t i = 0U; i < 20000U; ++i)
+				input += "T" + std::to_string(i % 997U) + ".F" + std::to_string(i) +
+				         "\n";
+		const auto lines = fasm_parser{view(input)}.parse();
+		ASSERT(lines.is_ok());
+		for (const auto &line : lines.unwrap())
+		{
+			const auto &feature = *line.feature;
+			ASSERT_EQUAL(*symbol_table::global().find(feature.feature[0]),
+			             feature.tile_id);
+			ASSERT_EQUAL(*symbol_table::global().find(feature.feature[1]),
+			             feature.suffix_id);
+		}
+	}
+
+	{
+		// values are printed in their canonical form, sized hex or unsized
+		// decimal.
+		const struct
+		{
+			lak::astring_view text;
+			lak::astring_view canonical;
+			bool big;
+		} values[] = {
+		  {"X = 5"_view, "X = 5"_view, false},
+		  {"X = 1_000"_view, "X = 1000"_view, false},
+		  {"X[7:0] = 8'b1010_0101"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 8'o2_45"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 8'd1_65"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 8'hA_5"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 8 'h a5"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 'b1010_0101"_view, "X[7:0] = 165"_view, false},
+		  {"X[7:0] = 'o245"_view, "X[7:0] = 165"_view, false},
+		  {"X[7:0] = 'd165"_view, "X[7:0] = 165"_view, false},
+		  {"X[7:0] = 'hA5"_view, "X[7:0] = 165"_view, false},
+		  {"X[7:0] = 0x8'hA5"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 0b1000'hA5"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[7:0] = 0o10'hA5"_view, "X[7:0] = 8'ha5"_view, false},
+		  {"X[63:0] = 64'hFFFF_FFFF_FFFF_FFFF"_view,
+		   "X[63:0] = 64'hffffffffffffffff"_view,
+		   false},
+		  {"X = 18446744073709551615"_view,
+		   "X = 18446744073709551615"_view,
+		   false},
+		  {"X[64:0] = 65'h1_0000_0000_0000_0000"_view,
+		   "X[64:0] = 65'h10000000000000000"_view,
+		   true},
+		  {"X = 18446744073709551616"_view,
+		   "X = 18446744073709551616"_view,
+		   true},
+		  {"X[65:0] = 66'o4_0000000000_0000000000_0"_view,
+		   "X[65:0] = 66'h20000000000000000"_view,
+		   true},
+		  {"X[64:0] = 65'b1_0000000000000000_0000000000000000"
+		   "_0000000000000000_0000000000000000"_view,
+		   "X[64:0] = 65'h10000000000000000"_view,
+		   true},
+		  {"X[127:0] = 128'hFFFFFFFF_FFFFFFFF_FFFFFFFF_FFFFFFFF"_view,
+		   "X[127:0] = 128'hffffffffffffffffffffffffffffffff"_view,
+		   true},
+		};
+		for (const auto &value : values)
+		{
+			const auto line = parse_line(value.text);
+			ASSERT(line.is_ok());
+			const auto &feature = *line.unwrap().feature;
+			ASSERT_EQUAL(lak::streamify(feature), value.canonical.to_string());
+			ASSERT_EQUAL(
+			  feature.value->value.template get<lak::bigint>() != nullptr,
+			  value.big);
+		}
+
+		// addresses and widths have to fit a uintmax_t.
+		ASSERT_EQUAL(parse_line("X[18446744073709551616] = 1"_view).unwrap_err(),
+		             error_type::integer_overflow);
+		ASSERT_EQUAL(parse_line("X = 18446744073709551616'h1"_view).unwrap_err(),
+		             error_type::integer_overflow);
+		ASSERT_EQUAL(parse_line("X = 8'hG"_view).unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line("X = 8'b2"_view).unwrap_err(),
+		             error_type::unexpected_character);
+	}
+
+	{
+		const auto line =
+		  parse_line(
+		    R"(X { .attr = "say \"hi\"", name_2 = "", x_y="c" } # comment)"_view)
+		    .unwrap();
+		ASSERT(line.feature);
+		ASSERT_EQUAL(line.annotations.size(), 3U);
+		ASSERT_EQUAL(line.annotations[0].name, ".attr"_view);
+		ASSERT_EQUAL(line.annotations[0].value, R"(say \"hi\")"_view);
+		ASSERT_EQUAL(line.annotations[1].name, "name_2"_view);
+		ASSERT_EQUAL(line.annotations[1].value, ""_view);
+		ASSERT_EQUAL(line.annotations[2].name, "x_y"_view);
+		ASSERT_EQUAL(line.annotations[2].value, "c"_view);
+		ASSERT_EQUAL(line.comment, "# comment"_view);
+
+		ASSERT(!parse_line(R"({ a = "b" })"_view).unwrap().feature);
+		ASSERT_EQUAL(parse_line(R"(X { _a = "b" })"_view).unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line(R"(X { a = "b })"_view).unwrap_err(),
+		             error_type::end_of_file);
+	}
+
+	{
+		// quoted values, comments and blank runs either side of the 16 and 32
+		// byte blocks, with the escaped quote at every position.
+		for (size_t length = 0U; length < 70U; ++length)
+		{
+			lak::astring blanks;
+			for (size_t i = 0U; i < length; ++i) blanks += i % 3U ? ' ' : '\t';
+
+			lak::astring comment = "#";
+			for (size_t i = 0U; i < length; ++i) comment += char('a' + (i % 26U));
+
+			for (size_t quote = 0U; quote <= length; quote += 1U + (length / 8U))
+			{
+				lak::astring value(length, 'v');
+				value.insert(quote, "\\\"");
+
+				const lak::astring str = "X" + blanks + "=" + blanks + "1" + blanks +
+				                         "{ a = \"" + value + "\" }" + blanks +
+				                         comment + "\r\nY" + blanks + "\r\n\r\n";
+				const auto lines = fasm_parser{view(str)}.parse();
+				ASSERT(lines.is_ok());
+				ASSERT_EQUAL(lines.unwrap().size(), 2U);
+				const auto &line = lines.unwrap()[0];
+				ASSERT_EQUAL(lak::streamify(*line.feature), "X = 1");
+				ASSERT_EQUAL(line.annotations[0].value, view(value));
+				ASSERT_EQUAL(line.comment, view(comment));
+				ASSERT_EQUAL(lines.unwrap()[1].feature->name, "Y"_view);
+			}
+		}
+	}
+
+	{
+		// CRLF and blank lines fold into the line before them.
+		const auto lines =
+		  fasm_parser{"\r\nA\r\n\r\nB = 1\n\nC # c\r\n"_view}.parse();
+		ASSERT(lines.is_ok());
+		ASSERT_EQUAL(lines.unwrap().size(), 4U);
+		ASSERT(!lines.unwrap()[0].feature);
+		ASSERT_EQUAL(lines.unwrap()[1].feature->name, "A"_view);
+		ASSERT_EQUAL(lak::streamify(*lines.unwrap()[2].feature), "B = 1");
+		ASSERT_EQUAL(lines.unwrap()[3].comment, "# c"_view);
+	}
+
+	{
+		// enough lines that chunk boundaries land next to blank lines, CRLFs,
+		// annotations and comments.
+		lak::astring input;
+		for (size_t i = 0U; i < 300U; ++i)
+		{
+			input += "TILE_X" + std::to_string(i) + "Y0.FEATURE";
+			switch (i % 5U)
+			{
+				case 0U: input += "\n"; break;
+				case 1U: input += "[7:0] = 8'hA5\r\n"; break;
+				case 2U: input += " { name = \"value\" }\n\n\n"; break;
+				case 3U: input += " # comment\r\n\r\n"; break;
+				case 4U: input += "[3] = 1'b1\n"; break;
+			}
+		}
+		const lak::astring_view input_view(input.data(),
+		                                   input.data() + input.size());
+
+		const auto serial = fasm_parser{input_view}.parse();
+		ASSERT(serial.is_ok());
+		ASSERT_EQUAL(serial.unwrap().size(), 300U);
+
+		for (const size_t jobs : {2U, 3U, 5U, 8U})
+		{
+			thread_pool pool(jobs);
+			for (const size_t min_chunk_size : {size_t(1U), size_t(97U)})
+			{
+				const auto parallel =
+				  fasm_parser{input_view}.parse_parallel(pool, min_chunk_size);
+				ASSERT(parallel.is_ok());
+				ASSERT_EQUAL(parallel.unwrap().size(), serial.unwrap().size());
+				for (size_t i = 0U; i < serial.unwrap().size(); ++i)
+					ASSERT_EQUAL(lak::streamify(parallel.unwrap()[i]),
+					             lak::streamify(serial.unwrap()[i]));
+			}
+		}
+
+		// an error near the end is reported at its line in the whole input,
+		// not within its chunk.
+		const size_t error_line =
+		  size_t(std::count(input.begin(), input.end(), '\n')) + 1U;
+		input += "TILE.FEATURE[\n";
+		for (size_t i = 0U; i < 10U; ++i) input += "TILE.FEATURE\r\n";
+		const lak::astring_view bad_view(input.data(),
+		                                 input.data() + input.size());
+
+		fasm_parser serial_parser{bad_view};
+		const auto serial_error = serial_parser.parse();
+		ASSERT(serial_error.is_err());
+		ASSERT_EQUAL(fasm_parser::make_line_error(bad_view,
+		                                          serial_parser.input.begin(),
+		                                          serial_error.unwrap_err())
+		               .line_number,
+		             error_line);
+
+		thread_pool pool(4U);
+		const auto parallel_error =
+		  fasm_parser{bad_view}.parse_parallel(pool, 1U);
+		ASSERT(parallel_error.is_err());
+		ASSERT_EQUAL(parallel_error.unwrap_err().line_number, error_line);
+		ASSERT_EQUAL(parallel_error.unwrap_err().error,
+		             serial_error.unwrap_err());
+	}
+
 	DEBUG(LAK_GREEN "FASM tests complete" LAK_SGR_RESET);
 }
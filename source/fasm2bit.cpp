@@ -1,29 +1,144 @@
 #include "fasm2bit.hpp"
 
+#include <algorithm>
 #include <fstream>
 
+#if defined(__unix__) || defined(__APPLE__)
+#	define FASM2BIT_HAS_MMAP
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
 const lak::astring_view help_string =
   "Usage: fasm2bit "
   "--[un]compressed "
   "--fasm <path to fasm> "
+  "--cache <path to database cache> "
+  "--build-cache "
+  "--preload-segbits (load every tile type's segbits alongside the "
+  "tilegrid instead of on first use) "
+  "--jobs <number of threads for parsing and database loading, 0 for all "
+  "cores> "
+  "--base-fasm <path to the fasm of --base-bitstream> "
+  "--base-bitstream <path to a bitstream to patch with only the frames of "
+  "the tiles that changed since --base-fasm> "
   "--out <path to output bitstream>"_view;
 
 lak::errno_result<std::vector<char>> read_file(const fs::path &path)
 {
-	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	std::ifstream file(path, std::ios::binary);
 	if (!file.is_open()) return lak::err_t{lak::errno_error::last_error()};
 
-	std::streampos file_size = file.tellg();
-	if (file_size == std::streampos(-1))
-		return lak::err_t{lak::errno_error::last_error()};
+	// pipes and procfs files report no (or a zero) size, so the size is only
+	// a hint and the stream is read until it ends.
+	std::vector<char> result;
+	std::error_code ec;
+	if (const auto size = fs::file_size(path, ec); !ec)
+		result.reserve(static_cast<size_t>(size) + 1U);
 
-	file.seekg(0);
-	if (file.fail()) return lak::err_t{lak::errno_error::last_error()};
+	for (;;)
+	{
+		const size_t offset = result.size();
+		result.resize(std::max(result.capacity(), offset + 0x10000U));
+		file.read(result.data() + offset,
+		          static_cast<std::streamsize>(result.size() - offset));
+		result.resize(offset + static_cast<size_t>(file.gcount()));
+		if (file.eof()) break;
+		if (file.fail()) return lak::err_t{lak::errno_error::last_error()};
+	}
+
+	return lak::ok_t{lak::move(result)};
+}
 
-	auto result = std::vector<char>(static_cast<size_t>(file_size), char{0});
+lak::errno_result<lak::monostate> write_file(const fs::path &path,
+                                             lak::span<const uint8_t> data)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) return lak::err_t{lak::errno_error::last_error()};
 
-	file.read(reinterpret_cast<char *>(result.data()), result.size());
+	file.write(reinterpret_cast<const char *>(data.data()), data.size());
 	if (file.fail()) return lak::err_t{lak::errno_error::last_error()};
 
+	return lak::ok_t{};
+}
+
+mapped_file::mapped_file(mapped_file &&other)
+{
+	*this = lak::move(other);
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&other)
+{
+	if (this == &other) return *this;
+
+	reset();
+
+	_mapped = other._mapped;
+	_buffer = lak::move(other._buffer);
+	_size   = other._size;
+	_data   = _mapped ? other._data : _buffer.data();
+
+	other._data   = nullptr;
+	other._size   = 0U;
+	other._mapped = false;
+
+	return *this;
+}
+
+mapped_file::~mapped_file()
+{
+	reset();
+}
+
+void mapped_file::reset()
+{
+#if defined(FASM2BIT_HAS_MMAP)
+	if (_mapped) ::munmap(const_cast<char *>(_data), _size);
+#endif
+	_data   = nullptr;
+	_size   = 0U;
+	_mapped = false;
+	// clear() would keep the allocation.
+	std::vector<char>().swap(_buffer);
+}
+
+lak::errno_result<mapped_file> map_file(const fs::path &path)
+{
+	mapped_file result;
+
+#if defined(FASM2BIT_HAS_MMAP)
+	if (const int fd = ::open(path.c_str(), O_RDONLY); fd != -1)
+	{
+		DEFER(::close(fd));
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+			return lak::err_t{lak::errno_error::last_error()};
+
+		// only regular files with a size can be mapped, pipes and procfs files
+		// (which report a size of 0) are read through the stream path.
+		const size_t size = static_cast<size_t>(st.st_size);
+		if (void *data = S_ISREG(st.st_mode) && size > 0U
+		                   ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+		                   : MAP_FAILED;
+		    data != MAP_FAILED)
+		{
+			// all of the parsers walk their input front to back.
+			::madvise(data, size, MADV_SEQUENTIAL);
+			result._data   = static_cast<const char *>(data);
+			result._size   = size;
+			result._mapped = true;
+			return lak::ok_t{lak::move(result)};
+		}
+	}
+	// fall through to the ifstream path, it will report any open errors.
+#endif
+
+	RES_TRY_ASSIGN(result._buffer =, read_file(path));
+	result._data = result._buffer.data();
+	result._size = result._buffer.size();
+
 	return lak::ok_t{lak::move(result)};
 }
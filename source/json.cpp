@@ -4,27 +4,23 @@
 
 lak::astring_view json_parser::parse_whitespace()
 {
-	const char *begin = input.begin();
-
-	while (pop_char({' ', '\t', '\n', '\r'}).is_ok())
-		;
-
-	return lak::astring_view(begin, input.begin());
+	return skip_while<char_classes::whitespace>();
 }
 
 json_parser::result<json_parser::string> json_parser::parse_string()
 {
-	RES_TRY(pop_char({'"'}));
+	RES_TRY(pop_char<char_classes::one_of<'"'>>());
 
 	string result;
 	const char *begin = input.begin();
 
-	while (pop_not_char({'\\', '"'}).is_ok() || pop_string("\\\""_view).is_ok())
-		;
+	do
+		skip_until<char_classes::string_delimiter>();
+	while (pop_string("\\\""_view).is_ok());
 
 	result.value = lak::astring_view(begin, input.begin());
 
-	RES_TRY(pop_char({'"'}));
+	RES_TRY(pop_char<char_classes::one_of<'"'>>());
 
 	return lak::ok_t{result};
 }
@@ -33,32 +29,27 @@ json_parser::result<lak::astring_view> json_parser::parse_number()
 {
 	const char *begin = input.begin();
 
-	auto digits = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	static constexpr char_class non_zero_digit = char_class::range('1', '9');
 
-	pop_char({'-'}).discard();
+	pop_char<char_classes::one_of<'-'>>().discard();
 
-	if (pop_char({'0'}).is_err())
+	if (pop_char<char_classes::one_of<'0'>>().is_err())
 	{
-		RES_TRY(peek_char({'1', '2', '3', '4', '5', '6', '7', '8', '9'}));
-		do
-		{
-			RES_TRY(pop());
-		} while (peek_char(digits).is_ok());
+		RES_TRY(pop_char<non_zero_digit>());
+		skip_while<char_classes::digit>();
 	}
 
-	if (pop_char({'.'}).is_ok())
+	if (pop_char<char_classes::one_of<'.'>>().is_ok())
 	{
-		RES_TRY(pop_char(digits));
-		while (pop_char(digits).is_ok())
-			;
+		RES_TRY(pop_char<char_classes::digit>());
+		skip_while<char_classes::digit>();
 	}
 
-	if (pop_char({'e', 'E'}).is_ok())
+	if (pop_char<char_classes::one_of<'e', 'E'>>().is_ok())
 	{
-		pop_char({'-', '+'}).discard();
-		RES_TRY(pop_char(digits));
-		while (pop_char(digits).is_ok())
-			;
+		pop_char<char_classes::one_of<'-', '+'>>().discard();
+		RES_TRY(pop_char<char_classes::digit>());
+		skip_while<char_classes::digit>();
 	}
 
 	return lak::ok_t{lak::astring_view(begin, input.begin())};
@@ -81,20 +72,26 @@ json_parser::result<json_parser::array> json_parser::parse_array()
 {
 	array result;
 
-	RES_TRY(pop_char({'['}));
+	RES_TRY(pop_char<char_classes::one_of<'['>>());
 
 	parse_whitespace();
 
-	while (peek_char({']'}).is_err())
+	const size_t first = value_stack.size();
+
+	while (peek_char<char_classes::one_of<']'>>().is_err())
 	{
 		RES_TRY_ASSIGN(value_type v =, parse_value());
-		result.values.push_back(lak::move(v));
+		value_stack.push_back(lak::move(v));
 		parse_whitespace();
-		if (pop_char({','}).is_err()) break;
+		if (pop_char<char_classes::one_of<','>>().is_err()) break;
 		parse_whitespace();
 	}
 
-	RES_TRY(pop_char({']'}));
+	RES_TRY(pop_char<char_classes::one_of<']'>>());
+
+	result.values = nodes.move_range(value_stack.data() + first,
+	                                 value_stack.data() + value_stack.size());
+	value_stack.erase(value_stack.begin() + first, value_stack.end());
 
 	return lak::ok_t{lak::move(result)};
 }
@@ -107,7 +104,7 @@ json_parser::result<json_parser::key_value> json_parser::parse_key_value()
 
 	parse_whitespace();
 
-	pop_char({':'}).discard();
+	pop_char<char_classes::one_of<':'>>().discard();
 
 	parse_whitespace();
 
@@ -120,20 +117,28 @@ json_parser::result<json_parser::object> json_parser::parse_object()
 {
 	object result;
 
-	RES_TRY(pop_char({'{'}));
+	RES_TRY(pop_char<char_classes::one_of<'{'>>());
 
 	parse_whitespace();
 
-	while (peek_char({'}'}).is_err())
+	const size_t first = key_value_stack.size();
+
+	while (peek_char<char_classes::one_of<'}'>>().is_err())
 	{
 		RES_TRY_ASSIGN(key_value kv =, parse_key_value());
-		result.key_values.push_back(lak::move(kv));
+		key_value_stack.push_back(lak::move(kv));
 		parse_whitespace();
-		if (pop_char({','}).is_err()) break;
+		if (pop_char<char_classes::one_of<','>>().is_err()) break;
 		parse_whitespace();
 	}
 
-	RES_TRY(pop_char({'}'}));
+	RES_TRY(pop_char<char_classes::one_of<'}'>>());
+
+	result.key_values =
+	  nodes.move_range(key_value_stack.data() + first,
+	                   key_value_stack.data() + key_value_stack.size());
+	key_value_stack.erase(key_value_stack.begin() + first,
+	                      key_value_stack.end());
 
 	return lak::ok_t{lak::move(result)};
 }
@@ -142,15 +147,15 @@ json_parser::result<json_parser::value_type> json_parser::parse_value()
 {
 	value_type result;
 
-	if (peek_char({'"'}).is_ok())
+	if (peek_char<char_classes::one_of<'"'>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.value =, parse_string());
 	}
-	else if (peek_char({'{'}).is_ok())
+	else if (peek_char<char_classes::one_of<'{'>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.value =, parse_object());
 	}
-	else if (peek_char({'['}).is_ok())
+	else if (peek_char<char_classes::one_of<'['>>().is_ok())
 	{
 		RES_TRY_ASSIGN(result.value =, parse_array());
 	}
@@ -162,10 +167,18 @@ json_parser::result<json_parser::value_type> json_parser::parse_value()
 	return lak::ok_t{lak::move(result)};
 }
 
-json_parser::result<json_parser::value_type> json_parser::parse()
+json_parser::result<json_parser::document> json_parser::parse()
 {
+	value_stack.clear();
+	key_value_stack.clear();
+
 	parse_whitespace();
-	return parse_value();
+
+	document result;
+	RES_TRY_ASSIGN(result.root =, parse_value());
+	result.nodes = lak::move(nodes);
+
+	return lak::ok_t{lak::move(result)};
 }
 
 std::ostream &operator<<(std::ostream &strm,
@@ -214,9 +227,124 @@ std::ostream &operator<<(std::ostream &strm, const json_parser::string &value)
 	return strm << "\"" << value.value << "\"";
 }
 
+// flattens events into a string, so the event and tree parsers can be
+// compared token for token.
+struct json_event_recorder
+{
+	lak::astring events;
+
+	void start_object() { events += "{"; }
+	void end_object() { events += "}"; }
+	void start_array() { events += "["; }
+	void end_array() { events += "]"; }
+	void key(lak::astring_view key) { events += "k:" + key.to_string() + ";"; }
+	void string(lak::astring_view value)
+	{
+		events += "s:" + value.to_string() + ";";
+	}
+	void literal(lak::astring_view value)
+	{
+		events += "l:" + value.to_string() + ";";
+	}
+
+	void record(const json_parser::value_type &value)
+	{
+		if (const auto *lit = value.lit(); lit)
+			literal(*lit);
+		else if (const auto *str = value.str(); str)
+			string(*str);
+		else if (const auto *arr = value.arr(); arr)
+		{
+			start_array();
+			for (const auto &v : arr->values) record(v);
+			end_array();
+		}
+		else if (const auto *obj = value.obj(); obj)
+		{
+			start_object();
+			for (const auto &kv : obj->key_values)
+			{
+				key(kv.key.value);
+				record(kv.value);
+			}
+			end_object();
+		}
+	}
+};
+
 void json_test()
 {
 	SCOPED_CHECKPOINT("JSON tests");
 
+	const auto view = [](const lak::astring &str)
+	{ return lak::astring_view(str.data(), str.data() + str.size()); };
+
+	{
+		const auto doc = json_parser{
+		  "{\"a\": [1, -0.5e+3, 0, 10E-2, true, false, null, \"s\\\"q\"],"
+		  " \"b\":{}, \"c\" : [ ] }"_view}
+		                   .parse();
+		ASSERT(doc.is_ok());
+		const auto *root = doc.unwrap().root.obj();
+		ASSERT(root);
+		ASSERT_EQUAL(root->key_values.size(), 3U);
+		const auto *a = root->find("a"_view);
+		ASSERT(a && a->arr());
+		const auto &values = a->arr()->values;
+		ASSERT_EQUAL(values.size(), 8U);
+		ASSERT_EQUAL(*values[0].lit(), "1"_view);
+		ASSERT_EQUAL(*values[1].lit(), "-0.5e+3"_view);
+		ASSERT_EQUAL(*values[2].lit(), "0"_view);
+		ASSERT_EQUAL(*values[3].lit(), "10E-2"_view);
+		ASSERT_EQUAL(*values[4].lit(), "true"_view);
+		ASSERT_EQUAL(*values[5].lit(), "false"_view);
+		ASSERT_EQUAL(*values[6].lit(), "null"_view);
+		// strings are left escaped.
+		ASSERT_EQUAL(*values[7].str(), "s\\\"q"_view);
+		ASSERT(root->find("b"_view)->obj()->key_values.empty());
+		ASSERT(root->find("c"_view)->arr()->values.empty());
+		ASSERT(!root->find("d"_view));
+	}
+
+	for (const auto *bad : {"[01]", "[-]", "[1.]", "[1e]", "[1,", "{\"a\":1",
+	                        "\"abc", "\"abc\\\"", "[tru]", "{1:2}"})
+	{
+		ASSERT(json_parser{lak::astring_view::from_c_str(bad)}.parse().is_err());
+		json_event_recorder recorder;
+		ASSERT(json_parser{lak::astring_view::from_c_str(bad)}
+		         .parse_events(recorder)
+		         .is_err());
+	}
+
+	// whitespace runs and strings either side of the 16 and 32 byte scans,
+	// with an escaped quote moving through each position.
+	for (size_t length = 0U; length < 70U; ++length)
+	{
+		lak::astring ws;
+		for (size_t i = 0U; i < length % 41U; ++i) ws += " \t\r\n"[i % 4U];
+		lak::astring str(length, 's');
+		if (length > 0U) str.insert(length / 2U, "\\\"");
+
+		const lak::astring input =
+		  ws + "{" + ws + "\"k" + str + "\"" + ws + ":" + ws + "[" + ws + "\"" +
+		  str + "\"" + ws + "," + ws + "-12.5e-3" + ws + "," + ws + "{}" + ws +
+		  "," + ws + "[" + ws + "]" + ws + "]" + ws + "," + ws + "\"n\":null" +
+		  ws + "}" + ws;
+
+		const auto doc = json_parser{view(input)}.parse();
+		ASSERT(doc.is_ok());
+		const auto &kv = doc.unwrap().root.obj()->key_values[0];
+		ASSERT_EQUAL(kv.key.value, view("k" + str));
+		ASSERT_EQUAL(*kv.value.arr()->values[0].str(), view(str));
+
+		json_event_recorder from_tree;
+		from_tree.record(doc.unwrap().root);
+
+		json_event_recorder from_events;
+		ASSERT(json_parser{view(input)}.parse_events(from_events).is_ok());
+
+		ASSERT_EQUAL(from_events.events, from_tree.events);
+	}
+
 	DEBUG(LAK_GREEN "JSON tests complete" LAK_SGR_RESET);
 }
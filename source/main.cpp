@@ -1,14 +1,20 @@
+#include "bigint.hpp"
 #include "bit.hpp"
 #include "csv.hpp"
 #include "database.hpp"
 #include "fasm.hpp"
 #include "fasm2bit.hpp"
 #include "json.hpp"
+#include "segbits.hpp"
+#include "thread_pool.hpp"
 
 #include "lak/result.hpp"
 #include "lak/stdint.hpp"
 #include "lak/string_literals.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <thread>
 #include <vector>
 
 struct argument_iterator
@@ -49,6 +55,26 @@ struct argument_iterator
 	bool empty() { return argc <= 0; }
 };
 
+// maps and parses a whole FASM file, the lines point into file.
+static lak::result<std::vector<fasm_parser::line>> parse_fasm_file(
+  const fs::path &path, mapped_file &file, thread_pool &pool)
+{
+	RES_TRY_ASSIGN(file =,
+	               map_file(path).map_err(
+	                 [&](const auto &err) -> lak::monostate
+	                 {
+		                 user_error("Failed to open fasm file ", path, ": ", err);
+		                 return {};
+	                 }));
+
+	return fasm_parser{file.view()}.parse_parallel(pool).map_err(
+	  [&](const auto &err) -> lak::monostate
+	  {
+		  user_error("Failed to parse fasm file ", path, ": ", err);
+		  return {};
+	  });
+}
+
 lak::result<lak::monostate> res_main(int argc, const char **argv)
 {
 	argument_iterator arg_iter{.argc = argc - 1, .argv = argv + 1};
@@ -59,7 +85,13 @@ lak::result<lak::monostate> res_main(int argc, const char **argv)
 	fs::path database_path;
 	fs::path fasm_path;
 	fs::path out_path;
-	bool compressed = false;
+	fs::path cache_path;
+	fs::path base_fasm_path;
+	fs::path base_bitstream_path;
+	bool build_cache     = false;
+	bool preload_segbits = false;
+	bool compressed      = false;
+	size_t jobs          = 1U;
 
 	do
 	{
@@ -71,9 +103,13 @@ lak::result<lak::monostate> res_main(int argc, const char **argv)
 		}
 		else if (command == "--test"_view)
 		{
+			bigint_test();
 			json_test();
 			csv_test();
 			fasm_test();
+			segbits_test();
+			bit_test();
+			database_test();
 			return lak::ok_t{};
 		}
 		else if (command == "--compressed"_view)
@@ -101,13 +137,49 @@ lak::result<lak::monostate> res_main(int argc, const char **argv)
 			database_path =
 			  arg_iter.pop("Expected database root path, got nothing"_view);
 		}
+		else if (command == "--jobs"_view || command == "-j"_view)
+		{
+			const auto jobs_str =
+			  arg_iter.pop("Expected number of jobs, got nothing"_view);
+			if (const auto [ptr, ec] =
+			      std::from_chars(jobs_str.begin(), jobs_str.end(), jobs);
+			    ec != std::errc{} || ptr != jobs_str.end())
+			{
+				user_error("Invalid number of jobs '"_view, jobs_str, "'"_view);
+				return lak::err_t{};
+			}
+			if (jobs == 0U)
+				jobs = std::max(1U, std::thread::hardware_concurrency());
+		}
 		else if (command == "--fasm"_view)
 		{
 			fasm_path = arg_iter.pop("Expected fasm path, got nothing"_view);
 		}
+		else if (command == "--cache"_view)
+		{
+			cache_path = arg_iter.pop("Expected cache path, got nothing"_view);
+		}
+		else if (command == "--build-cache"_view)
+		{
+			build_cache = true;
+		}
+		else if (command == "--preload-segbits"_view)
+		{
+			preload_segbits = true;
+		}
+		else if (command == "--base-fasm"_view)
+		{
+			base_fasm_path =
+			  arg_iter.pop("Expected base fasm path, got nothing"_view);
+		}
+		else if (command == "--base-bitstream"_view)
+		{
+			base_bitstream_path =
+			  arg_iter.pop("Expected base bitstream path, got nothing"_view);
+		}
 		else if (command == "--out"_view)
 		{
-			const auto out_path_res{arg_iter.pop()};
+			out_path = arg_iter.pop("Expected output path, got nothing"_view);
 		}
 		else
 		{
@@ -117,91 +189,296 @@ lak::result<lak::monostate> res_main(int argc, const char **argv)
 		}
 	} while (!arg_iter.empty());
 
-	// --- fasm ---
+	if (base_fasm_path.empty() != base_bitstream_path.empty())
+	{
+		user_error("--base-fasm and --base-bitstream must be used together");
+		return lak::err_t{};
+	}
 
-	RES_TRY_ASSIGN(const std::vector<char> fasm_file =,
-	               read_file(fasm_path).map_err(
-	                 [&](const auto &err) -> lak::monostate
-	                 {
-		                 user_error(
-		                   "Failed to open fasm file ", fasm_path, ": ", err);
-		                 return {};
-	                 }));
+	// --- build cache ---
+
+	if (build_cache)
+	{
+		if (cache_path.empty())
+		{
+			user_error("--build-cache requires --cache <path>");
+			return lak::err_t{};
+		}
 
-	RES_TRY_ASSIGN(
-	  std::vector<fasm_parser::line> fasm_lines =,
-	  fasm_parser{lak::astring_view(lak::span(fasm_file))}.parse().map_err(
-	    [&](const auto &err) -> lak::monostate
-	    {
-		    user_error("Failed to parse fasm file ", fasm_path, ": ", err);
-		    return {};
-	    }));
+		RES_TRY_ASSIGN(database db =,
+		               database::open(database_path, family_name, fabric_name));
 
-	for (const auto &line : fasm_lines) DEBUG(line);
+		thread_pool pool(jobs);
+		return db.write_cache(cache_path, pool);
+	}
+
+	// --- database files ---
+
+	// the files are independent (bar the frame memory, which is built from
+	// part.json) so they're loaded as a task graph over --jobs threads.
 
-	// --- package pins csv ---
+	thread_pool pool(jobs);
+	task_graph loads;
 
 	const fs::path package_pins_csv_path =
 	  database_path / family_name / package_name / "package_pins.csv";
+	mapped_file package_pins_file;
+	std::vector<csv_parser::line> package_pins;
 
-	RES_TRY_ASSIGN(const std::vector<char> package_pins_file =,
-	               read_file(package_pins_csv_path)
-	                 .map_err(
-	                   [&](const auto &err) -> lak::monostate
-	                   {
-		                   user_error("Failed to open package pins file ",
-		                              package_pins_csv_path,
-		                              ": ",
-		                              err);
-		                   return {};
-	                   }));
-
-	RES_TRY_ASSIGN(std::vector<csv_parser::line> package_pins =,
-	               csv_parser{lak::astring_view(lak::span(package_pins_file))}
-	                 .parse()
-	                 .map_err(
-	                   [&](const auto &err) -> lak::monostate
-	                   {
-		                   user_error("Failed to parse package pins file ",
-		                              package_pins_csv_path,
-		                              ": ",
-		                              err);
-		                   return {};
-	                   }));
+	loads.add(
+	  [&]() -> lak::result<lak::monostate>
+	  {
+		  RES_TRY_ASSIGN(package_pins_file =,
+		                 map_file(package_pins_csv_path)
+		                   .map_err(
+		                     [&](const auto &err) -> lak::monostate
+		                     {
+			                     user_error("Failed to open package pins file ",
+			                                package_pins_csv_path,
+			                                ": ",
+			                                err);
+			                     return {};
+		                     }));
 
-	for (const auto &line : package_pins) DEBUG(line);
+		  RES_TRY_ASSIGN(package_pins =,
+		                 csv_parser{package_pins_file.view()}
+		                   .parse()
+		                   .map_err(
+		                     [&](const auto &err) -> lak::monostate
+		                     {
+			                     user_error("Failed to parse package pins file ",
+			                                package_pins_csv_path,
+			                                ": ",
+			                                err);
+			                     return {};
+		                     }));
 
-	// --- part json ---
+		  return lak::ok_t{};
+	  });
 
 	const fs::path part_json_path =
 	  database_path / family_name / package_name / "part.json";
+	mapped_file part_json_file;
+	json_parser::document part_json;
+
+	const task_graph::task_id part_json_task = loads.add(
+	  [&]() -> lak::result<lak::monostate>
+	  {
+		  RES_TRY_ASSIGN(
+		    part_json_file =,
+		    map_file(part_json_path)
+		      .map_err(
+		        [&](const auto &err) -> lak::monostate
+		        {
+			        user_error(
+			          "Failed to open part file ", part_json_path, ": ", err);
+			        return {};
+		        }));
+
+		  RES_TRY_ASSIGN(
+		    part_json =,
+		    json_parser{part_json_file.view()}.parse().map_err(
+		      [&](const auto &err) -> lak::monostate
+		      {
+			      user_error(
+			        "Failed to parse part file ", part_json_path, ": ", err);
+			      return {};
+		      }));
+
+		  return lak::ok_t{};
+	  });
+
+	frame_memory frames;
+
+	loads.add(
+	  [&]() -> lak::result<lak::monostate>
+	  {
+		  RES_TRY_ASSIGN(
+		    frames =,
+		    frame_memory::from_part(part_json.root)
+		      .map_err(
+		        [&](const auto &) -> lak::monostate
+		        {
+			        user_error("Failed to build frame memory from part file ",
+			                   part_json_path);
+			        return {};
+		        }));
+
+		  return lak::ok_t{};
+	  },
+	  {part_json_task});
+
+	// only lists and stats the database files, so the tilegrid and each
+	// segbits file can be separate tasks.
+	RES_TRY_ASSIGN(database db =,
+	               database::index(database_path, family_name, fabric_name));
 
-	RES_TRY_ASSIGN(
-	  const std::vector<char> part_json_file =,
-	  read_file(part_json_path)
-	    .map_err(
-	      [&](const auto &err) -> lak::monostate
-	      {
-		      user_error("Failed to open part file ", part_json_path, ": ", err);
-		      return {};
-	      }));
-
-	RES_TRY_ASSIGN(
-	  const json_parser::value_type part_json =,
-	  json_parser{lak::astring_view(lak::span(part_json_file))}.parse().map_err(
-	    [&](const auto &err) -> lak::monostate
-	    {
-		    user_error("Failed to parse part file ", part_json_path, ": ", err);
-		    return {};
-	    }));
-
-	DEBUG(part_json);
-
-	// --- database ---
-
-	RES_TRY_ASSIGN(
-	  database db =,
-	  database::open(database_path, family_name, fabric_name, package_name));
+	if (!cache_path.empty() && db.open_cache(cache_path).is_err())
+		user_warning("Database cache ",
+		             cache_path,
+		             " is missing or out of date, loading the text database");
+
+	loads.add([&] { return db.load_tilegrid(); });
+
+	// otherwise the segbits are loaded lazily, only for the tile types that
+	// are used.
+	if (preload_segbits) db.add_segbits_loads(loads);
+
+	RES_TRY(loads.run(pool));
+
+	for (const auto &line : package_pins) DEBUG(line);
+
+	DEBUG(part_json.root);
+
+	// --- incremental ---
+
+	// only the tiles whose features differ from the base FASM are assembled
+	// again, and only the frames they span are rewritten in the base
+	// bitstream.
+	if (!base_fasm_path.empty())
+	{
+		mapped_file base_fasm_file;
+		RES_TRY_ASSIGN(const std::vector<fasm_parser::line> base_lines =,
+		               parse_fasm_file(base_fasm_path, base_fasm_file, pool));
+
+		mapped_file fasm_file;
+		RES_TRY_ASSIGN(const std::vector<fasm_parser::line> fasm_lines =,
+		               parse_fasm_file(fasm_path, fasm_file, pool));
+
+		RES_TRY_ASSIGN(const mapped_file base_bitstream_file =,
+		               map_file(base_bitstream_path)
+		                 .map_err(
+		                   [&](const auto &err) -> lak::monostate
+		                   {
+			                   user_error("Failed to open base bitstream ",
+			                              base_bitstream_path,
+			                              ": ",
+			                              err);
+			                   return {};
+		                   }));
+
+		RES_TRY_ASSIGN(
+		  bitstream_image image =,
+		  read_bitstream(
+		    lak::span<const uint8_t>(
+		      reinterpret_cast<const uint8_t *>(base_bitstream_file.data().data()),
+		      base_bitstream_file.size()),
+		    frames)
+		    .map_err(
+		      [&](const auto &) -> lak::monostate
+		      {
+			      user_error("Failed to read base bitstream ", base_bitstream_path);
+			      return {};
+		      }));
+
+		std::vector<uint32_t> touched;
+		RES_TRY_ASSIGN(const size_t reassembled =,
+		               db.assemble_changes(lak::span(base_lines),
+		                                   lak::span(fasm_lines),
+		                                   frames,
+		                                   touched));
+
+		DEBUG(reassembled, " tiles reassembled, ", touched.size(), " frames");
+
+		if (out_path.empty()) return lak::ok_t{};
+
+		if (patch_bitstream(image, frames, lak::span<const uint32_t>(touched))
+		      .is_err())
+		{
+			user_warning("Base bitstream ",
+			             base_bitstream_path,
+			             " can't be patched in place, writing all frames");
+			image.bytes = compressed ? write_compressed_bitstream(frames)
+			                         : write_bitstream(frames);
+		}
+
+		const std::vector<uint8_t> &bitstream = image.bytes;
+		return write_file(out_path, lak::span(bitstream))
+		  .map_err(
+		    [&](const auto &err) -> lak::monostate
+		    {
+			    user_error("Failed to write bitstream ", out_path, ": ", err);
+			    return {};
+		    });
+	}
+
+	// --- fasm ---
+
+	frame_edits edits;
+
+	RES_TRY_ASSIGN(const mapped_file fasm_file =,
+	               map_file(fasm_path).map_err(
+	                 [&](const auto &err) -> lak::monostate
+	                 {
+		                 user_error(
+		                   "Failed to open fasm file ", fasm_path, ": ", err);
+		                 return {};
+	                 }));
+
+	if (fasm_parser fasm{fasm_file.view()}; jobs > 1U)
+	{
+		RES_TRY_ASSIGN(
+		  std::vector<fasm_parser::line> fasm_lines =,
+		  fasm.parse_parallel(pool).map_err(
+		    [&](const auto &err) -> lak::monostate
+		    {
+			    user_error("Failed to parse fasm file ", fasm_path, ": ", err);
+			    return {};
+		    }));
+
+		for (const auto &line : fasm_lines)
+		{
+			DEBUG(line);
+			if (line.feature) RES_TRY(db.resolve(*line.feature, frames, edits));
+		}
+	}
+	else
+	{
+		// the parser can't be stopped from the callback, so only the first
+		// resolve failure is kept and reported once parsing is done.
+		bool resolve_failed = false;
+		RES_TRY(fasm
+		          .parse(
+		            [&](fasm_parser::line &&line)
+		            {
+			            DEBUG(line);
+			            if (line.feature && !resolve_failed)
+				            resolve_failed =
+				              db.resolve(*line.feature, frames, edits).is_err();
+		            })
+		          .map_err(
+		            [&](const auto &err) -> lak::monostate
+		            {
+			            user_error("Failed to parse fasm file ",
+			                       fasm_path,
+			                       ": ",
+			                       fasm_parser::make_line_error(
+			                         fasm_file.view(), fasm.input.begin(), err));
+			            return {};
+		            }));
+		if (resolve_failed) return lak::err_t{};
+	}
+
+	// the resolved bits are applied frame by frame rather than one at a time.
+	edits.apply(frames);
+
+	// --- bitstream ---
+
+	if (!out_path.empty())
+	{
+		const std::vector<uint8_t> bitstream =
+		  compressed ? write_compressed_bitstream(frames)
+		             : write_bitstream(frames);
+
+		RES_TRY(write_file(out_path, lak::span(bitstream))
+		          .map_err(
+		            [&](const auto &err) -> lak::monostate
+		            {
+			            user_error(
+			              "Failed to write bitstream ", out_path, ": ", err);
+			            return {};
+		            }));
+	}
 
 	return lak::ok_t{};
 }
@@ -3,6 +3,7 @@
 #include "lak/architecture.hpp"
 #include "lak/memmanip.hpp"
 
+#include <bit>
 #include <cmath>
 
 #if !defined(LAK_ARCH_X86_64) && !defined(LAK_ARCH_X86) &&                    \
@@ -379,3 +380,52 @@ lak::uintmax2_t lak::mul_uintmax2(uintmax_t A, uintmax_t B)
 	         static_cast<uintmax_t>(mid.low << half_shift),
 	};
 }
+
+lak::uintmax_div_rem_t lak::div_uintmax2(lak::uintmax2_t A, uintmax_t B)
+{
+	// Hacker's Delight divlu, two half width long division steps.
+	constexpr uintmax_t half_shift = (CHAR_BIT * sizeof(uintmax_t)) / 2U;
+	constexpr uintmax_t half_base  = uintmax_t(1U) << half_shift;
+	constexpr uintmax_t half_mask  = UINTMAX_MAX >> half_shift;
+
+	ASSERT_LESS(A.high, B);
+
+	// normalise so the top bit of the divisor is set.
+	const int shift = std::countl_zero(B);
+	B <<= shift;
+	const uintmax_t b_high = B >> half_shift;
+	const uintmax_t b_low  = B & half_mask;
+
+	const uintmax_t a_32 =
+	  shift == 0 ? A.high
+	             : (A.high << shift) |
+	                 (A.low >> ((CHAR_BIT * sizeof(uintmax_t)) - shift));
+	const uintmax_t a_10 = A.low << shift;
+	const uintmax_t a_1  = a_10 >> half_shift;
+	const uintmax_t a_0  = a_10 & half_mask;
+
+	uintmax_t q_1   = a_32 / b_high;
+	uintmax_t r_hat = a_32 - (q_1 * b_high);
+	while (q_1 >= half_base || q_1 * b_low > ((r_hat << half_shift) | a_1))
+	{
+		--q_1;
+		r_hat += b_high;
+		if (r_hat >= half_base) break;
+	}
+
+	const uintmax_t a_21 = ((a_32 << half_shift) | a_1) - (q_1 * B);
+
+	uintmax_t q_0 = a_21 / b_high;
+	r_hat         = a_21 - (q_0 * b_high);
+	while (q_0 >= half_base || q_0 * b_low > ((r_hat << half_shift) | a_0))
+	{
+		--q_0;
+		r_hat += b_high;
+		if (r_hat >= half_base) break;
+	}
+
+	return {
+	  .quotient  = (q_1 << half_shift) | q_0,
+	  .remainder = (((a_21 << half_shift) | a_0) - (q_0 * B)) >> shift,
+	};
+}
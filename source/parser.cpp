@@ -16,49 +16,6 @@ basic_parser::result<char> basic_parser::pop()
 	return lak::ok_t{result};
 }
 
-basic_parser::result<char> basic_parser::peek_char(
-  std::initializer_list<char> c)
-{
-	RES_TRY_ASSIGN(const char v =, peek());
-	for (const char i : c)
-		if (i == v) return lak::ok_t{v};
-	return lak::err_t{error_type::unexpected_character};
-}
-
-basic_parser::result<char> basic_parser::pop_char(
-  std::initializer_list<char> c)
-{
-	RES_TRY_ASSIGN(const char v =, peek());
-	for (const char i : c)
-	{
-		if (i == v)
-		{
-			pop().unwrap();
-			return lak::ok_t{v};
-		}
-	}
-	return lak::err_t{error_type::unexpected_character};
-}
-
-basic_parser::result<char> basic_parser::peek_not_char(
-  std::initializer_list<char> c)
-{
-	RES_TRY_ASSIGN(const char v =, peek());
-	for (const char i : c)
-		if (i == v) return lak::err_t{error_type::unexpected_character};
-	return lak::ok_t{v};
-}
-
-basic_parser::result<char> basic_parser::pop_not_char(
-  std::initializer_list<char> c)
-{
-	RES_TRY_ASSIGN(const char v =, peek());
-	for (const char i : c)
-		if (i == v) return lak::err_t{error_type::unexpected_character};
-	pop().unwrap();
-	return lak::ok_t{v};
-}
-
 basic_parser::result<lak::astring_view> basic_parser::peek_string(
   lak::astring_view str)
 {
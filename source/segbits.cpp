@@ -0,0 +1,135 @@
+#include "segbits.hpp"
+
+#include "lak/string_literals.hpp"
+
+#include <charconv>
+
+lak::astring_view segbits_parser::parse_whitespace()
+{
+	return skip_while<char_classes::blank>();
+}
+
+segbits_parser::result<uint32_t> segbits_parser::parse_uint()
+{
+	uint32_t result = 0U;
+
+	const auto [ptr, ec] = std::from_chars(input.begin(), input.end(), result);
+	if (ec == std::errc::result_out_of_range)
+		return lak::err_t{error_type::integer_overflow};
+	if (ec != std::errc{}) return lak::err_t{error_type::unexpected_character};
+
+	input = lak::astring_view(ptr, input.end());
+
+	return lak::ok_t{result};
+}
+
+segbits_parser::result<segbit> segbits_parser::parse_bit()
+{
+	const bool value = pop_char<char_classes::one_of<'!'>>().is_err();
+	RES_TRY_ASSIGN(const uint32_t frame =, parse_uint());
+	RES_TRY(pop_char<char_classes::one_of<'_'>>());
+	RES_TRY_ASSIGN(const uint32_t bit =, parse_uint());
+
+	if (frame > segbit::max_frame || bit > segbit::max_bit)
+		return lak::err_t{error_type::integer_overflow};
+
+	return lak::ok_t{segbit::make(frame, bit, value)};
+}
+
+segbits_parser::result<segbits_parser::line> segbits_parser::parse_line()
+{
+	line result;
+
+	result.feature = skip_until<char_classes::whitespace>();
+	if (result.feature.empty())
+		return lak::err_t{error_type::unexpected_character};
+
+	for (;;)
+	{
+		parse_whitespace();
+		if (input.empty() || peek_char<char_classes::newline>().is_ok()) break;
+		RES_TRY_ASSIGN(const segbit bit =, parse_bit());
+		result.bits.push_back(bit);
+	}
+
+	return lak::ok_t{lak::move(result)};
+}
+
+std::ostream &operator<<(std::ostream &strm, const segbit &bit)
+{
+	if (!bit.value()) strm << "!";
+	return strm << bit.frame() << "_" << bit.bit();
+}
+
+std::ostream &operator<<(std::ostream &strm, const segbits_parser::line &line)
+{
+	strm << line.feature;
+	for (const auto &bit : line.bits) strm << " " << bit;
+	return strm;
+}
+
+void segbits_test()
+{
+	SCOPED_CHECKPOINT("Segbits tests");
+
+	const auto parse_line = [](lak::astring_view str)
+	{ return segbits_parser{str}.parse_line(); };
+
+	using error_type = segbits_parser::error_type;
+
+	{
+		segbits_parser parser{"CLBLL_L.SLICEL_X0.AFF.ZINI 31_12 !30_13\n"
+		                      "CLBLL_L.SLICEL_X0.AFF.ZRST 0_0\r\n"_view};
+		std::vector<segbits_parser::line> lines;
+		ASSERT(parser.parse([&](segbits_parser::line &&l)
+		                    { lines.push_back(lak::move(l)); })
+		         .is_ok());
+		ASSERT_EQUAL(lines.size(), 2U);
+
+		ASSERT_EQUAL(lines[0].feature, "CLBLL_L.SLICEL_X0.AFF.ZINI"_view);
+		ASSERT_EQUAL(lines[0].bits.size(), 2U);
+		ASSERT_EQUAL(lines[0].bits[0], segbit::make(31U, 12U, true));
+		ASSERT_EQUAL(lines[0].bits[1].frame(), 30U);
+		ASSERT_EQUAL(lines[0].bits[1].word(), 0U);
+		ASSERT_EQUAL(lines[0].bits[1].word_bit(), 13U);
+		ASSERT(!lines[0].bits[1].value());
+
+		ASSERT_EQUAL(lines[1].feature, "CLBLL_L.SLICEL_X0.AFF.ZRST"_view);
+		ASSERT_EQUAL(lines[1].bits.size(), 1U);
+		ASSERT_EQUAL(lines[1].bits[0], segbit::make(0U, 0U, true));
+	}
+
+	{
+		// the largest frame and bit offsets still fit, one more doesn't.
+		const auto result = parse_line("FEATURE !524287_4095");
+		ASSERT(result.is_ok());
+		const segbit bit = result.unwrap().bits[0];
+		ASSERT_EQUAL(bit.frame(), segbit::max_frame);
+		ASSERT_EQUAL(bit.bit(), segbit::max_bit);
+		ASSERT_EQUAL(bit.word(), 127U);
+		ASSERT_EQUAL(bit.word_bit(), 31U);
+		ASSERT(!bit.value());
+
+		ASSERT_EQUAL(parse_line("FEATURE 524288_0").unwrap_err(),
+		             error_type::integer_overflow);
+		ASSERT_EQUAL(parse_line("FEATURE 0_4096").unwrap_err(),
+		             error_type::integer_overflow);
+		ASSERT_EQUAL(parse_line("FEATURE 4294967296_0").unwrap_err(),
+		             error_type::integer_overflow);
+	}
+
+	{
+		ASSERT_EQUAL(parse_line("FEATURE 31-12").unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line("FEATURE _12").unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line("FEATURE !!31_12").unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line("FEATURE 31_").unwrap_err(),
+		             error_type::unexpected_character);
+		ASSERT_EQUAL(parse_line(" 31_12").unwrap_err(),
+		             error_type::unexpected_character);
+	}
+
+	DEBUG(LAK_GREEN "Segbits tests complete" LAK_SGR_RESET);
+}
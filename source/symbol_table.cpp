@@ -0,0 +1,191 @@
+#include "symbol_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+size_t symbol_table::probe(uint64_t hash, lak::astring_view str) const
+{
+	const size_t mask = _slots.size() - 1U;
+	for (size_t index = size_t(hash) & mask;; index = (index + 1U) & mask)
+	{
+		const slot &s = _slots[index];
+		if (s.id == empty_slot) return index;
+		// the stored hash rejects almost every mismatch without touching the
+		// string.
+		if (s.hash == hash && _names[s.id] == str) return index;
+	}
+}
+
+lak::astring_view symbol_table::copy_to_arena(lak::astring_view str)
+{
+	char *data;
+	if (str.size() > arena_block_size / 4U)
+	{
+		// big strings get their own block so they don't waste the current one.
+		_arena.push_back(std::make_unique<char[]>(str.size()));
+		data = _arena.back().get();
+	}
+	else
+	{
+		if (!_arena_block || _arena_used + str.size() > arena_block_size)
+		{
+			_arena.push_back(std::make_unique<char[]>(arena_block_size));
+			_arena_block = _arena.back().get();
+			_arena_used  = 0U;
+		}
+		data = _arena_block + _arena_used;
+		_arena_used += str.size();
+	}
+	std::copy(str.begin(), str.end(), data);
+	return lak::astring_view(data, data + str.size());
+}
+
+void symbol_table::rehash(size_t slot_count)
+{
+	std::vector<slot> old = lak::move(_slots);
+	_slots.assign(slot_count, slot{.hash = 0U, .id = empty_slot});
+	const size_t mask = slot_count - 1U;
+	for (const slot &s : old)
+	{
+		if (s.id == empty_slot) continue;
+		size_t index = size_t(s.hash) & mask;
+		while (_slots[index].id != empty_slot) index = (index + 1U) & mask;
+		_slots[index] = s;
+	}
+}
+
+symbol_id symbol_table::intern(lak::astring_view str)
+{
+	const uint64_t hash = symbol_hash(str);
+
+	// most strings are interned many times, only the first needs to write.
+	{
+		std::shared_lock lock(_mutex);
+		if (!_slots.empty())
+			if (const slot &s = _slots[probe(hash, str)]; s.id != empty_slot)
+				return s.id;
+	}
+
+	std::unique_lock lock(_mutex);
+
+	// keep the load factor at or below 1/2.
+	if ((_names.size() + 1U) * 2U > _slots.size())
+		rehash(std::max<size_t>(_slots.size() * 2U, 1024U));
+
+	slot &s = _slots[probe(hash, str)];
+	if (s.id == empty_slot)
+	{
+		s.hash = hash;
+		s.id   = symbol_id(_names.size());
+		_names.push_back(copy_to_arena(str));
+	}
+	return s.id;
+}
+
+std::vector<symbol_id> symbol_table::adopt(lak::span<const entry> entries)
+{
+	std::vector<symbol_id> result;
+	result.reserve(entries.size());
+
+	std::unique_lock lock(_mutex);
+
+	if ((_names.size() + entries.size()) * 2U > _slots.size())
+		rehash(std::max<size_t>(
+		  std::bit_ceil((_names.size() + entries.size()) * 2U), 1024U));
+
+	// the entries are distinct, so in an empty table the first free slot
+	// along each probe sequence is the entry's own.
+	const bool fresh  = _names.empty();
+	const size_t mask = _slots.size() - 1U;
+	for (const entry &e : entries)
+	{
+		size_t index;
+		if (fresh)
+		{
+			index = size_t(e.hash) & mask;
+			while (_slots[index].id != empty_slot) index = (index + 1U) & mask;
+		}
+		else
+			index = probe(e.hash, e.name);
+
+		slot &s = _slots[index];
+		if (s.id == empty_slot)
+		{
+			s.hash = e.hash;
+			s.id   = symbol_id(_names.size());
+			_names.push_back(copy_to_arena(e.name));
+		}
+		result.push_back(s.id);
+	}
+
+	return result;
+}
+
+lak::optional<symbol_id> symbol_table::find(lak::astring_view str) const
+{
+	const uint64_t hash = symbol_hash(str);
+
+	std::shared_lock lock(_mutex);
+
+	if (_slots.empty()) return lak::optional<symbol_id>{};
+
+	if (const slot &s = _slots[probe(hash, str)]; s.id != empty_slot)
+		return lak::optional<symbol_id>{s.id};
+	return lak::optional<symbol_id>{};
+}
+
+lak::astring_view symbol_table::name(symbol_id id) const
+{
+	std::shared_lock lock(_mutex);
+	return _names[id];
+}
+
+size_t symbol_table::size() const
+{
+	std::shared_lock lock(_mutex);
+	return _names.size();
+}
+
+symbol_table &symbol_table::global()
+{
+	static symbol_table table;
+	return table;
+}
+
+// only picks a cache entry, so unlike symbol_hash it needn't be stable.
+// reads the string a word at a time.
+static size_t cache_hash(lak::astring_view str, size_t bits)
+{
+	constexpr uint64_t multiplier = 0x9E3779B97F4A7C15U;
+
+	const char *data = str.begin();
+	size_t size      = str.size();
+	uint64_t hash    = size;
+	for (; size >= sizeof(uint64_t);
+	     data += sizeof(uint64_t), size -= sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, data, sizeof(word));
+		hash = std::rotl((hash ^ word) * multiplier, 29);
+	}
+	if (size > 0U)
+	{
+		uint64_t word = 0U;
+		std::memcpy(&word, data, size);
+		hash ^= word;
+	}
+	return size_t((hash * multiplier) >> (64U - bits));
+}
+
+symbol_id symbol_cache::intern(lak::astring_view str)
+{
+	if (_entries.empty()) _entries.resize(size_t(1U) << entry_bits);
+
+	entry &e = _entries[cache_hash(str, entry_bits)];
+	if (e.id != empty_entry && e.name == str) return e.id;
+
+	e.id   = _table->intern(str);
+	e.name = _table->name(e.id);
+	return e.id;
+}
@@ -0,0 +1,181 @@
+#include "thread_pool.hpp"
+
+#include "lak/debug.hpp"
+
+#include <algorithm>
+
+// the pool (if any) whose worker is the current thread.
+static thread_local const thread_pool *current_pool = nullptr;
+static thread_local size_t current_queue           = 0U;
+
+thread_pool::thread_pool(size_t job_count)
+{
+	job_count = std::max<size_t>(job_count, 1U);
+	_queues.reserve(job_count);
+	for (size_t i = 0U; i < job_count; ++i)
+		_queues.push_back(std::make_unique<queue>());
+	_threads.reserve(job_count - 1U);
+	for (size_t i = 0U; i + 1U < job_count; ++i)
+		_threads.emplace_back([this, i] { worker(i); });
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard lock(_mutex);
+		_stop = true;
+	}
+	_changed.notify_all();
+	for (auto &thread : _threads) thread.join();
+}
+
+size_t thread_pool::this_queue() const
+{
+	return current_pool == this ? current_queue : _queues.size() - 1U;
+}
+
+void thread_pool::submit(task t)
+{
+	// counted before it's published, so the thread that takes it can't
+	// decrement _queued first.
+	{
+		std::lock_guard lock(_mutex);
+		++_queued;
+	}
+	{
+		queue &q = *_queues[this_queue()];
+		std::lock_guard lock(q.mutex);
+		q.tasks.push_back(lak::move(t));
+	}
+	_changed.notify_all();
+}
+
+bool thread_pool::run_one(size_t self)
+{
+	task t;
+
+	// newest of our own first, it's the most likely to still be in cache.
+	{
+		queue &q = *_queues[self];
+		std::lock_guard lock(q.mutex);
+		if (!q.tasks.empty())
+		{
+			t = lak::move(q.tasks.back());
+			q.tasks.pop_back();
+		}
+	}
+
+	for (size_t i = 1U; !t && i < _queues.size(); ++i)
+	{
+		queue &q = *_queues[(self + i) % _queues.size()];
+		std::lock_guard lock(q.mutex);
+		if (!q.tasks.empty())
+		{
+			t = lak::move(q.tasks.front());
+			q.tasks.pop_front();
+		}
+	}
+
+	if (!t) return false;
+
+	{
+		std::lock_guard lock(_mutex);
+		ASSERT_GREATER(_queued, 0U);
+		--_queued;
+	}
+
+	t();
+
+	// wake anyone in wait_until to recheck their condition. taking the lock
+	// stops the notify landing between their check and their wait.
+	{
+		std::lock_guard lock(_mutex);
+	}
+	_changed.notify_all();
+
+	return true;
+}
+
+void thread_pool::worker(size_t self)
+{
+	current_pool  = this;
+	current_queue = self;
+
+	for (;;)
+	{
+		if (run_one(self)) continue;
+
+		std::unique_lock lock(_mutex);
+		_changed.wait(lock, [&] { return _stop || _queued > 0U; });
+		if (_stop) return;
+	}
+}
+
+void thread_pool::wait_until(const std::function<bool()> &done)
+{
+	const size_t self = this_queue();
+
+	while (!done())
+	{
+		if (run_one(self)) continue;
+
+		std::unique_lock lock(_mutex);
+		_changed.wait(lock, [&] { return _queued > 0U || done(); });
+	}
+}
+
+task_graph::task_id task_graph::add(
+  task t, std::initializer_list<task_id> dependencies)
+{
+	const task_id id   = _nodes.size();
+	node &n            = _nodes.emplace_back();
+	n.func             = lak::move(t);
+	n.dependency_count = dependencies.size();
+	for (const task_id dependency : dependencies)
+		_nodes[dependency].dependents.push_back(id);
+	return id;
+}
+
+lak::result<lak::monostate> task_graph::run(thread_pool &pool)
+{
+	_unfinished = _nodes.size();
+	_failed     = false;
+	for (node &n : _nodes)
+	{
+		n.remaining = n.dependency_count;
+		n.skipped   = false;
+	}
+
+	for (task_id id = 0U; id < _nodes.size(); ++id)
+		if (_nodes[id].dependency_count == 0U) start(pool, id);
+
+	pool.wait_until([&] { return _unfinished == 0U; });
+
+	if (_failed) return lak::err_t{};
+	return lak::ok_t{};
+}
+
+void task_graph::start(thread_pool &pool, task_id id)
+{
+	if (_nodes[id].skipped)
+	{
+		finish(pool, id, false);
+		return;
+	}
+
+	pool.submit([this, &pool, id]
+	            { finish(pool, id, _nodes[id].func().is_ok()); });
+}
+
+void task_graph::finish(thread_pool &pool, task_id id, bool ok)
+{
+	if (!ok) _failed = true;
+
+	for (const task_id dependent : _nodes[id].dependents)
+	{
+		if (!ok) _nodes[dependent].skipped = true;
+		if (--_nodes[dependent].remaining == 0U) start(pool, dependent);
+	}
+
+	--_unfinished;
+}